@@ -34,6 +34,7 @@ class FetchppConan(ConanFile):
         self.requires("boost/1.78.0-r3")
         self.requires("nlohmann_json/3.10.2")
         self.requires("skyr-url/1.13.0-r4")
+        self.requires("zlib/1.2.12")
 
     def build_requirements(self):
         self.build_requires("catch2/2.13.6-r1")
@@ -2,11 +2,15 @@
 
 #include <fetchpp/core/detail/client.hpp>
 #include <fetchpp/core/detail/overloaded.hpp>
+#include <fetchpp/core/dns_cache.hpp>
+#include <fetchpp/core/retry_policy.hpp>
+#include <fetchpp/core/ssl_session_cache.hpp>
 #include <fetchpp/core/session.hpp>
 #include <fetchpp/http/proxy.hpp>
 #include <fetchpp/http/response.hpp>
 
 #include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/variant2/variant.hpp>
 
@@ -14,11 +18,30 @@
 #include <fetchpp/alias/net.hpp>
 #include <fetchpp/alias/ssl.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <deque>
+#include <limits>
+#include <list>
+#include <memory>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 namespace fetchpp
 {
+// how a request picks one of the sessions already opened to its endpoint
+enum class session_selection
+{
+  // the oldest session below max_pending_per_session()
+  first_available,
+  least_pending,
+  // the least loaded of two sessions picked at random
+  power_of_two_choices,
+  round_robin,
+};
 
 class client
 {
@@ -35,12 +58,30 @@ public:
          std::chrono::nanoseconds,
          net::ssl::context context);
 
-  using plain_session = session<plain_endpoint, tcp_async_transport>;
-  using secure_session = session<secure_endpoint, ssl_async_transport>;
-  using tunnel_session = session<tunnel_endpoint, tunnel_async_transport>;
+  // the responses are parsed from the contiguous read buffer of the
+  // transports, whatever the storage of their body
+  using plain_session = session<plain_endpoint, tcp_flat_async_transport>;
+  using secure_session = session<secure_endpoint, ssl_flat_async_transport>;
+  using tunnel_session =
+      session<tunnel_endpoint, tunnel_flat_async_transport>;
   using session_adapter =
       boost::variant2::variant<plain_session, secure_session, tunnel_session>;
-  using sessions = std::deque<session_adapter>;
+  using sessions = std::list<session_adapter>;
+  // sessions are looked up by endpoint, each endpoint keeping the list of
+  // its own connections
+  struct endpoint_sessions
+  {
+    std::vector<session_adapter*> sessions;
+    std::size_t next = 0;
+  };
+  // the sessions dedicated to priority requests are kept apart
+  struct endpoint_lanes
+  {
+    endpoint_sessions shared;
+    endpoint_sessions dedicated;
+  };
+  template <typename Endpoint>
+  using session_index = std::unordered_map<Endpoint, endpoint_lanes>;
 
   using internal_executor_type = net::strand<net::any_io_executor>;
   using default_executor_type =
@@ -52,11 +93,56 @@ public:
   std::size_t max_pending_per_session() const;
   void set_max_pending_per_session(std::size_t pending);
   std::size_t session_count() const;
+  // once the session limits are reached, new requests are queued on the
+  // existing sessions of their endpoint, or wait for a session to be released
+  std::size_t max_sessions() const;
+  void set_max_sessions(std::size_t max);
+  std::size_t max_sessions_per_host() const;
+  void set_max_sessions_per_host(std::size_t max);
+  std::size_t waiting_requests() const;
+  session_selection selection() const;
+  // HTTP/1.1 pipelining of GET and HEAD requests on new sessions, see
+  // session_base::set_pipeline_depth
+  std::size_t pipeline_depth() const;
+  void set_pipeline_depth(std::size_t depth);
+  void set_session_selection(session_selection policy);
+  // requests of at least this priority go to sessions dedicated to them, up
+  // to priority_sessions_per_host() per endpoint on top of
+  // max_sessions_per_host(). They fall back on the shared sessions when no
+  // dedicated one can be opened. nullopt, the default, disables it
+  std::optional<int> priority_threshold() const;
+  void set_priority_threshold(std::optional<int> threshold);
+  std::size_t priority_sessions_per_host() const;
+  void set_priority_sessions_per_host(std::size_t max);
+  // see session_base::set_priority_aging, applies to new sessions
+  std::chrono::nanoseconds priority_aging() const;
+  void set_priority_aging(std::chrono::nanoseconds period);
+  // applies to every session, they share one retry budget
+  fetchpp::retry_policy const& get_retry_policy() const;
+  void set_retry_policy(fetchpp::retry_policy policy);
+  std::shared_ptr<retry_budget> const& get_retry_budget() const;
+  // the number of pending tasks of each session, in creation order
+  std::vector<std::size_t> pending_tasks_per_session() const;
+  // sessions without any task for this long are closed, zero disables it
+  std::chrono::nanoseconds idle_timeout() const;
+  void set_idle_timeout(std::chrono::nanoseconds timeout);
   void set_verify_peer(bool v);
   net::ssl::context& context();
+  // the DNS cache used by the sessions created from now on
+  std::shared_ptr<fetchpp::dns_cache> const& get_dns_cache() const;
+  void set_dns_cache(std::shared_ptr<fetchpp::dns_cache> cache);
+  // the TLS sessions resumed by the sessions created from now on
+  std::shared_ptr<fetchpp::ssl_session_cache> const& get_ssl_session_cache()
+      const;
+  void set_ssl_session_cache(
+      std::shared_ptr<fetchpp::ssl_session_cache> cache);
   void add_proxy(http::proxy_match, http::proxy);
   void set_proxies(http::proxy_map);
   http::proxy_map const& proxies() const;
+  // the memory of the requests in flight, recycled from one request to the
+  // next, and the number of blocks it had to request from the system
+  std::shared_ptr<detail::recycling_pool> const& memory_pool() const;
+  std::size_t allocations() const;
 
   template <typename CompletionToken>
   auto async_stop(GracefulShutdown graceful, CompletionToken&& token)
@@ -76,24 +162,107 @@ public:
                       std::forward<CompletionToken>(token));
   }
 
+  // returns nullptr when no session can be created for this endpoint
   template <
       typename Endpoint,
       typename Session = typename detail::session_for_tunnel<Endpoint>::type>
-  auto& get_session(Endpoint endpoint)
+  session_adapter* get_session(Endpoint endpoint, int priority = 0)
+  {
+    if (priority_threshold_ && priority >= *priority_threshold_)
+    {
+      if (auto* adapter = get_lane_session<Session>(endpoint, true))
+        return adapter;
+    }
+    return get_lane_session<Session>(std::move(endpoint), false);
+  }
+
+  // parks a request until a session can be created, a waiter keeps its id
+  // when it parks again
+  std::uint64_t wait_for_session(detail::task::ptr_t waiter);
+  // a parked request is removed and completed with operation_aborted
+  void cancel_waiter(std::uint64_t id);
+
+  template <typename Request, typename CompletionToken>
+  auto async_fetch(Request request, CompletionToken&& token)
+  {
+    return async_fetch(std::move(request),
+                       http::response{},
+                       std::forward<CompletionToken>(token));
+  }
+
+  // the response is read into the given one and handed back, e.g. an
+  // http::streaming_response carrying the sink of its body
+  template <typename Request, typename Response, typename CompletionToken>
+  auto async_fetch(Request request, Response response, CompletionToken&& token)
+  {
+    auto launch =
+        [](auto&& handler, client* cl, Request request, Response response) {
+          auto op =
+              detail::client_fetch_op(*cl,
+                                      std::move(request),
+                                      std::move(response),
+                                      std::forward<decltype(handler)>(handler));
+          net::dispatch(std::move(op));
+        };
+    return net::async_initiate<CompletionToken, void(error_code, Response)>(
+        std::move(launch),
+        token,
+        this,
+        std::move(request),
+        std::move(response));
+  }
+
+private:
+  template <typename Session, typename Endpoint>
+  session_adapter* get_lane_session(Endpoint endpoint, bool dedicated)
   {
-    auto found = std::find_if(
-        sessions_.begin(), sessions_.end(), [&](auto const& adapter) {
-          return boost::variant2::visit(
-              detail::overloaded{[&](Session const& session) {
-                                   return endpoint == session.endpoint() &&
-                                          session.pending_tasks() <
-                                              max_pending_per_session();
-                                 },
-                                 [&](auto const&) { return false; }},
-              adapter);
-        });
-    if (found == sessions_.end())
+    auto const lane = [&]() -> endpoint_sessions& {
+      auto& entry = std::get<session_index<Endpoint>>(index_)[endpoint];
+      return dedicated ? entry.dedicated : entry.shared;
+    };
+    auto const limit =
+        dedicated ? priority_sessions_per_host_ : max_sessions_per_host_;
+    auto* candidates = &lane().sessions;
+    // a session that failed is revived once its tasks are drained, in the
+    // meantime it is replaced by a new one.
+    for (auto* adapter : *candidates)
+    {
+      auto& session = boost::variant2::get<Session>(*adapter);
+      if (session.failed() && session.idle())
+        session.revive();
+    }
+    // tasks not pushed yet are accounted for, so that concurrent requests do
+    // not all land on the same session
+    auto const load = [](session_adapter* adapter) {
+      auto const& session = boost::variant2::get<Session>(*adapter);
+      return session.failed() ? std::numeric_limits<std::size_t>::max() :
+                                session.pending_tasks() + session.reserved();
+    };
+    auto found = select_session(lane(), load);
+    if (found == candidates->end())
+    {
+      auto const room = make_room(candidates->size(), limit);
+      // making room may have retired a session of this endpoint
+      candidates = &lane().sessions;
+      found = candidates->end();
+      if (!room)
+      {
+        found = std::min_element(
+            candidates->begin(), candidates->end(), [&](auto lhs, auto rhs) {
+              return load(lhs) < load(rhs);
+            });
+        if (found == candidates->end() ||
+            load(*found) == std::numeric_limits<std::size_t>::max())
+          return nullptr;
+      }
+    }
+    if (found != candidates->end())
     {
+      boost::variant2::get<Session>(**found).reserve();
+      return *found;
+    }
+
+    auto& adapter = [&]() -> session_adapter& {
       if constexpr (Session::endpoint_type::is_secure::value)
         return sessions_.emplace_back(boost::variant2::in_place_type<Session>,
                                       std::move(endpoint),
@@ -105,29 +274,120 @@ public:
                                       std::move(endpoint),
                                       this->strand_,
                                       this->timeout_);
-    }
-    return *found;
+    }();
+    auto& session = boost::variant2::get<Session>(adapter);
+    session.on_idle([this] {
+      if (!waiters_.empty())
+        net::post(strand_, [this] { wake_waiters(); });
+    });
+    session.set_pipeline_depth(pipeline_depth_);
+    session.set_priority_aging(priority_aging_);
+    session.set_retry_policy(retry_policy_, retry_budget_);
+    session.transport().set_dns_cache(dns_cache_);
+    session.transport().set_ssl_session_cache(ssl_session_cache_);
+    session.reserve();
+    candidates->push_back(&adapter);
+    arm_reaper();
+    return &adapter;
   }
 
-  template <typename Request, typename CompletionToken>
-  auto async_fetch(Request request, CompletionToken&& token)
+  template <typename Load>
+  auto select_session(endpoint_sessions& entry, Load const& load)
   {
-    auto launch = [](auto&& handler, client* cl, Request request) {
-      auto op = detail::client_fetch_op(
-          *cl, std::move(request), std::forward<decltype(handler)>(handler));
-      net::dispatch(std::move(op));
+    auto& candidates = entry.sessions;
+    auto const available = [&](session_adapter* adapter) {
+      return load(adapter) < max_pending_per_session();
+    };
+    auto const least_pending = [&]() {
+      auto found = std::min_element(
+          candidates.begin(), candidates.end(), [&](auto lhs, auto rhs) {
+            return load(lhs) < load(rhs);
+          });
+      return (found != candidates.end() && available(*found)) ?
+                 found :
+                 candidates.end();
     };
-    return net::async_initiate<CompletionToken,
-                               void(error_code, http::response)>(
-        std::move(launch), token, this, std::move(request));
+    switch (selection_)
+    {
+    case session_selection::least_pending:
+      return least_pending();
+    case session_selection::power_of_two_choices:
+    {
+      if (candidates.size() < 2)
+        return least_pending();
+      auto const pick = [&](std::size_t count) {
+        std::uniform_int_distribution<std::size_t> distribution(0, count - 1);
+        return distribution(random_);
+      };
+      // the second choice is drawn among the other sessions
+      auto const first_index = pick(candidates.size());
+      auto second_index = pick(candidates.size() - 1);
+      if (second_index >= first_index)
+        ++second_index;
+      auto first = candidates.begin() + first_index;
+      auto second = candidates.begin() + second_index;
+      auto found = load(*second) < load(*first) ? second : first;
+      return available(*found) ? found : least_pending();
+    }
+    case session_selection::round_robin:
+      for (std::size_t i = 0; i < candidates.size(); ++i)
+      {
+        auto const position = (entry.next + i) % candidates.size();
+        if (available(candidates[position]))
+        {
+          entry.next = position + 1;
+          return candidates.begin() + position;
+        }
+      }
+      return candidates.end();
+    case session_selection::first_available:
+    default:
+      return std::find_if(candidates.begin(), candidates.end(), available);
+    }
   }
 
-private:
+  bool make_room(std::size_t endpoint_sessions, std::size_t per_host);
+  void retire_session(sessions::iterator it);
+  void wake_waiters();
+  void cancel_waiters();
+  void arm_reaper();
+  void cancel_reaper();
+  void reap_idle_sessions();
+
   internal_executor_type strand_;
+  // declared first, the requests parked in the client give their memory
+  // back on destruction
+  std::shared_ptr<detail::recycling_pool> pool_;
   std::chrono::nanoseconds timeout_;
   std::size_t max_pending_ = 10u;
+  std::size_t max_sessions_ = std::numeric_limits<std::size_t>::max();
+  std::size_t max_sessions_per_host_ = std::numeric_limits<std::size_t>::max();
+  std::chrono::nanoseconds idle_timeout_ = std::chrono::nanoseconds::zero();
+  session_selection selection_ = session_selection::first_available;
+  std::size_t pipeline_depth_ = 1u;
+  std::optional<int> priority_threshold_;
+  std::size_t priority_sessions_per_host_ = 1u;
+  std::chrono::nanoseconds priority_aging_ = std::chrono::seconds(1);
+  fetchpp::retry_policy retry_policy_;
+  std::shared_ptr<retry_budget> retry_budget_;
+  std::minstd_rand random_;
   net::ssl::context context_;
+  std::shared_ptr<fetchpp::dns_cache> dns_cache_;
+  std::shared_ptr<fetchpp::ssl_session_cache> ssl_session_cache_;
   sessions sessions_;
+  // sessions being stopped, kept alive until their stop completes
+  sessions retired_;
+  // cancelled once retired_ is empty, async_stop waits on it
+  net::steady_timer retired_drained_;
+  std::deque<detail::task::ptr_t> waiters_;
+  std::uint64_t last_waiter_id_ = 0;
+  net::steady_timer reaper_;
+  bool reaper_armed_ = false;
+  bool stopping_ = false;
+  std::tuple<session_index<plain_endpoint>,
+             session_index<secure_endpoint>,
+             session_index<tunnel_endpoint>>
+      index_;
   http::proxy_map proxies_;
 };
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <fetchpp/core/dns_cache.hpp>
 #include <fetchpp/core/endpoint.hpp>
 
 #include <boost/asio/buffer.hpp>
@@ -10,14 +11,18 @@
 
 #include <fetchpp/core/detail/cancel_socket.hpp>
 #include <fetchpp/core/detail/coroutine.hpp>
+#include <fetchpp/core/detail/transport_base.hpp>
 
 #include <fetchpp/alias/beast.hpp>
 #include <fetchpp/alias/error_code.hpp>
 #include <fetchpp/alias/net.hpp>
 #include <fetchpp/alias/tcp.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
+#include <memory>
+#include <optional>
 
 namespace fetchpp
 {
@@ -47,11 +52,11 @@ struct async_basic_connect_op
         transport_.reset();
       transport_.set_running(true);
       transport_.setup_timer();
-      FETCHPP_YIELD transport_.resolver_.async_resolve(
-          endpoint_.domain(),
-          std::to_string(endpoint_.port()),
-          net::ip::resolver_base::numeric_service,
-          std::move(self));
+      FETCHPP_YIELD async_resolve(transport_.resolver_,
+                                  transport_.get_dns_cache().get(),
+                                  endpoint_.domain(),
+                                  endpoint_.port(),
+                                  std::move(self));
       FETCHPP_YIELD do_async_connect(
           transport_, endpoint_.domain(), std::move(results), std::move(self));
       transport_.cancel_timer();
@@ -71,7 +76,7 @@ enum class GracefulShutdown : bool
 };
 
 template <typename AsyncStream, typename DynamicBuffer>
-class basic_async_transport
+class basic_async_transport : public detail::transport_base
 {
   static_assert(beast::is_async_stream<AsyncStream>::value,
                 "AsyncStream type requirements not met");
@@ -93,7 +98,8 @@ public:
                         std::chrono::nanoseconds timeout,
                         net::any_io_executor ex,
                         Args&&... args)
-    : stream_creator_([ex,
+    : detail::transport_base(timeout),
+      stream_creator_([ex,
                        params = std::tuple<Args...>(
                            std::forward<Args>(args)...)]() mutable {
         return std::apply(
@@ -104,8 +110,7 @@ public:
       }),
       buffer_(std::move(buffer)),
       stream_(std::make_unique<next_layer_type>(stream_creator_())),
-      resolver_(next_layer().get_executor()),
-      timeout_(timeout)
+      resolver_(next_layer().get_executor())
   {
   }
 
@@ -169,6 +174,7 @@ public:
             else
             {
               this->resolver().cancel();
+              this->cancel_connection_race();
               FETCHPP_YIELD net::post(
                   beast::bind_front_handler(std::move(self)));
             }
@@ -202,7 +208,7 @@ public:
 
   void setup_timer()
   {
-    get_lowest_layer(next_layer()).expires_after(timeout_);
+    get_lowest_layer(next_layer()).expires_after(operation_timeout());
   }
 
   void cancel_timer()
@@ -221,9 +227,15 @@ public:
     return beast::get_lowest_layer(next_layer()).socket().is_open();
   }
 
-  auto const& timeout() const
+  // drops the connection at once, the pending operations complete with
+  // net::error::operation_aborted
+  void abort()
   {
-    return timeout_;
+    set_running(false);
+    this->resolver().cancel();
+    this->cancel_connection_race();
+    error_code ignored;
+    beast::get_lowest_layer(next_layer()).socket().close(ignored);
   }
 
   auto get_executor()
@@ -241,23 +253,11 @@ public:
     return buffer_;
   }
 
-  void set_running(bool r = true)
-  {
-    running_ = r;
-  }
-
-  bool is_running() const
-  {
-    return running_;
-  }
-
 private:
   next_layer_creator stream_creator_;
   buffer_type buffer_;
   std::unique_ptr<next_layer_type> stream_;
   tcp::resolver resolver_;
-  std::chrono::nanoseconds timeout_;
-  bool running_ = true;
 };
 
 template <class T>
@@ -6,6 +6,8 @@
 #include <fetchpp/core/detail/async_http_result.hpp>
 #include <fetchpp/core/detail/endpoint.hpp>
 #include <fetchpp/core/detail/http_stable_async.hpp>
+#include <fetchpp/core/detail/recycling_pool.hpp>
+#include <fetchpp/core/detail/session_base.hpp>
 #include <fetchpp/core/endpoint.hpp>
 #include <fetchpp/core/session.hpp>
 #include <fetchpp/http/proxy.hpp>
@@ -15,6 +17,10 @@
 
 #include <fetchpp/alias/beast.hpp>
 
+#include <boost/asio/associated_cancellation_slot.hpp>
+#include <boost/asio/cancellation_type.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/variant2/variant.hpp>
 
 #include <deque>
@@ -27,42 +33,98 @@ struct session_for_tunnel;
 template <>
 struct session_for_tunnel<tunnel_endpoint>
 {
-  using type = session<tunnel_endpoint, tunnel_async_transport>;
+  using type = session<tunnel_endpoint, tunnel_flat_async_transport>;
 };
 template <>
 struct session_for_tunnel<secure_endpoint>
 {
-  using type = session<secure_endpoint, ssl_async_transport>;
+  using type = session<secure_endpoint, ssl_flat_async_transport>;
 };
 template <>
 struct session_for_tunnel<plain_endpoint>
 {
-  using type = session<plain_endpoint, tcp_async_transport>;
+  using type = session<plain_endpoint, tcp_flat_async_transport>;
 };
 
-template <typename Client, typename Request, typename Handler>
+template <typename Client,
+          typename Request,
+          typename Response,
+          typename Handler>
 struct client_fetch_data
 {
   Client& client;
   Request req;
   Handler handler;
-  http::response res = {};
+  Response res;
+  // keeps its value while the request waits for a session
+  std::uint64_t waiter_id = 0;
 
-  client_fetch_data(Client& client, Request&& request, Handler&& h)
-    : client(client), req(std::move(request)), handler(std::move(h))
+  client_fetch_data(Client& client,
+                    Request&& request,
+                    Response&& response,
+                    Handler&& h)
+    : client(client),
+      req(std::move(request)),
+      handler(std::move(h)),
+      res(std::move(response))
   {
   }
 };
 
-template <typename Client, typename Request, typename Handler>
+// the waiter memory comes from the pool of the client, it is given back by
+// destroy()
+template <typename Op>
+auto make_waiter(std::shared_ptr<recycling_pool> const& pool, Op&& op)
+{
+  struct client_waiter : detail::task
+  {
+    Op op_;
+    std::shared_ptr<recycling_pool> pool_;
+
+    client_waiter(Op&& op, std::shared_ptr<recycling_pool> pool)
+      : op_(std::move(op)), pool_(std::move(pool))
+    {
+    }
+
+    void destroy() noexcept override
+    {
+      auto pool = std::move(pool_);
+      this->~client_waiter();
+      pool->deallocate(this, sizeof(client_waiter), alignof(client_waiter));
+    }
+
+    void run() override
+    {
+      op_();
+    }
+
+    void cancel() override
+    {
+      op_(net::error::operation_aborted);
+    }
+  };
+  auto* memory = pool->allocate(sizeof(client_waiter), alignof(client_waiter));
+  return detail::task::ptr_t(new (memory) client_waiter(std::move(op), pool));
+}
+
+template <typename Client,
+          typename Request,
+          typename Response,
+          typename Handler>
 struct client_fetch_op
 {
-  using data_t = client_fetch_data<Client, Request, Handler>;
-  std::unique_ptr<data_t> data;
+  using data_t = client_fetch_data<Client, Request, Response, Handler>;
+  pooled_ptr<data_t> data;
 
-  client_fetch_op(Client& client, Request&& req, Handler&& handler)
-    : data(std::make_unique<data_t>(
-          client, std::forward<Request>(req), std::forward<Handler>(handler)))
+  client_fetch_op(Client& client,
+                  Request&& req,
+                  Response&& res,
+                  Handler&& handler)
+    : data(make_pooled<data_t>(client.memory_pool(),
+                               client,
+                               std::forward<Request>(req),
+                               std::forward<Response>(res),
+                               std::forward<Handler>(handler)))
   {
   }
 
@@ -72,45 +134,77 @@ struct client_fetch_op
     return data->client.get_internal_executor();
   }
 
+  using allocator_type = recycling_allocator<void>;
+  allocator_type get_allocator() const
+  {
+    return allocator_type(data->client.memory_pool());
+  }
+
+  // the sessions and the waiters listen to the slot of the user's handler
+  using cancellation_slot_type = net::associated_cancellation_slot_t<Handler>;
+  cancellation_slot_type get_cancellation_slot() const noexcept
+  {
+    return net::get_associated_cancellation_slot(data->handler);
+  }
+
   void operator()()
   {
     BOOST_ASSERT(data->client.get_internal_executor().running_in_this_thread());
 
     auto const& proxy =
         http::select_proxy(data->client.proxies(), data->req.uri());
-    auto request_pusher = [&](auto& s) {
-      return s.push_request(data->req, data->res, std::move(*this));
-    };
-
-    if (proxy.has_value())
+    auto const priority = request_priority(data->req);
+    auto* session = [&]() {
+      if (proxy.has_value())
+        return data->client.get_session(
+            tunnel_endpoint{to_endpoint<false>(proxy->url()),
+                            to_endpoint<true>(data->req.uri())},
+            priority);
+      else if (auto const& uri = data->req.uri(); http::is_ssl_involved(uri))
+        return data->client.get_session(to_endpoint<true>(uri), priority);
+      else
+        return data->client.get_session(to_endpoint<false>(uri), priority);
+    }();
+    if (!session)
     {
-      auto& session = data->client.get_session(
-          tunnel_endpoint{to_endpoint<false>(proxy->url()),
-                          to_endpoint<true>(data->req.uri())});
-      boost::variant2::visit(request_pusher, session);
-    }
-    else if (auto const& uri = data->req.uri(); http::is_ssl_involved(uri))
-    {
-      auto& session = data->client.get_session(to_endpoint<true>(uri));
-      boost::variant2::visit(request_pusher, session);
-    }
-    else
-    {
-      auto& session = data->client.get_session(to_endpoint<false>(uri));
-      boost::variant2::visit(request_pusher, session);
+      auto& client = data->client;
+      // the data stays put while *this is moved into the waiter
+      auto& parked = *data;
+      auto waiter = make_waiter(client.memory_pool(), std::move(*this));
+      waiter->id = parked.waiter_id;
+      parked.waiter_id = client.wait_for_session(std::move(waiter));
+      auto slot = net::get_associated_cancellation_slot(parked.handler);
+      if (slot.is_connected())
+      {
+        slot.assign([&client, id = parked.waiter_id](net::cancellation_type) {
+          net::post(client.get_internal_executor(),
+                    [&client, id] { client.cancel_waiter(id); });
+        });
+      }
+      return;
     }
+    boost::variant2::visit(
+        [&](auto& s) {
+          return s.push_request(data->req, data->res, std::move(*this));
+        },
+        *session);
   }
 
   void operator()(error_code ec)
   {
+    if (auto slot = get_cancellation_slot(); slot.is_connected())
+      slot.clear();
     net::make_post(beast::bind_front_handler(
                        std::move(data->handler), ec, std::move(data->res)),
                    data->client.get_internal_executor());
   }
 };
-template <typename Client, typename Request, typename CompletionHandler>
-client_fetch_op(Client&, Request, CompletionHandler)
-    -> client_fetch_op<Client, Request, CompletionHandler>;
+template <typename Client,
+          typename Request,
+          typename Response,
+          typename CompletionHandler>
+client_fetch_op(Client&, Request, Response, CompletionHandler)
+    -> client_fetch_op<Client, Request, Response, CompletionHandler>;
 
 template <typename Client, typename Handler>
 struct client_stop_sessions_op
@@ -128,6 +222,8 @@ struct client_stop_sessions_op
   {
     FETCHPP_REENTER(coro_)
     {
+      client_.stopping_ = true;
+      client_.cancel_reaper();
       begin_ = client_.sessions_.begin();
       end_ = client_.sessions_.end();
       while (begin_ != end_)
@@ -141,8 +237,16 @@ struct client_stop_sessions_op
           ec_ = ec;
         ++begin_;
       }
-      if (ec_)
-        ec = net::error::operation_aborted;
+      // the sessions retired to make room complete on the client
+      while (!client_.retired_.empty())
+      {
+        client_.retired_drained_.expires_at(
+            net::steady_timer::time_point::max());
+        FETCHPP_YIELD client_.retired_drained_.async_wait(std::move(*this));
+      }
+      client_.cancel_waiters();
+      client_.stopping_ = false;
+      ec = ec_ ? net::error::operation_aborted : error_code{};
       net::make_post(beast::bind_front_handler(std::move(handler_), ec),
                      get_executor().get_inner_executor());
     }
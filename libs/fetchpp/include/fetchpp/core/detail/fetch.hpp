@@ -7,6 +7,7 @@
 
 #include <fetchpp/net/make_post.hpp>
 
+#include <boost/asio/associated_cancellation_slot.hpp>
 #include <boost/asio/dispatch.hpp>
 #include <boost/asio/executor.hpp>
 
@@ -73,8 +74,11 @@ struct simple_fetch_op
     FETCHPP_REENTER(coro_)
     {
       FETCHPP_YIELD transport().async_connect(endpoint(), std::move(*this));
-      FETCHPP_YIELD async_process_one(
-          transport(), state().request, state().response, std::move(*this));
+      if (!ec)
+      {
+        FETCHPP_YIELD async_process_one(
+            transport(), state().request, state().response, std::move(*this));
+      }
       net::make_post(
           beast::bind_front_handler(
               std::move(state().handler), ec, std::move(state().response)),
@@ -86,6 +90,15 @@ struct simple_fetch_op
   {
     return state_->transport.get_executor();
   }
+
+  // the connection and the exchange are interrupted by the user's handler
+  // slot
+  using cancellation_slot_type =
+      net::associated_cancellation_slot_t<decltype(State::handler)>;
+  cancellation_slot_type get_cancellation_slot() const noexcept
+  {
+    return net::get_associated_cancellation_slot(state_->handler);
+  }
 };
 template <typename State>
 simple_fetch_op(std::unique_ptr<State>) -> simple_fetch_op<State>;
@@ -96,7 +109,7 @@ auto async_fetch(net::any_io_executor ex, Request&& request, CompletionToken&& t
   auto launch = [](auto&& handler, net::any_io_executor ex, Request request) {
     auto s = make_state<base_state, Response>(
         detail::to_endpoint<false>(request.uri()),
-        tcp_async_transport(ex, std::chrono::seconds(30)),
+        tcp_flat_async_transport(ex, std::chrono::seconds(30)),
         std::forward<Request>(request),
         std::forward<decltype(handler)>(handler));
     net::dispatch(simple_fetch_op{std::move(s)});
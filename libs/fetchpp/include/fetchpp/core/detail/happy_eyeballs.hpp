@@ -0,0 +1,223 @@
+#pragma once
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/compose.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/error.hpp>
+
+#include <fetchpp/alias/beast.hpp>
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/net.hpp>
+#include <fetchpp/alias/tcp.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace fetchpp::detail
+{
+// RFC 8305 section 4: alternate address families, starting with the one
+// the resolver preferred.
+std::vector<tcp::endpoint> interleave_address_families(
+    tcp::resolver::results_type const& results);
+
+// what a transport keeps of its connection race, so that closing the
+// transport does not wait for the attempts
+class connection_race
+{
+public:
+  virtual ~connection_race() = default;
+  // the race completes with net::error::operation_aborted, its attempts and
+  // timers are cancelled
+  virtual void cancel() = 0;
+};
+
+// one connection race, shared by the handlers of its attempts.
+// attempts start every attempt_delay, or as soon as the previous one fails.
+// The first connected socket is moved into target_, the others are closed.
+template <typename Socket, typename Self>
+class happy_eyeballs_race
+  : public connection_race,
+    public std::enable_shared_from_this<happy_eyeballs_race<Socket, Self>>
+{
+public:
+  happy_eyeballs_race(Socket& target,
+                      Self self,
+                      std::vector<tcp::endpoint> endpoints,
+                      std::chrono::nanoseconds attempt_delay,
+                      std::chrono::nanoseconds timeout)
+    : target_(target),
+      self_(std::move(self)),
+      strand_(target.get_executor()),
+      endpoints_(std::move(endpoints)),
+      attempt_delay_(attempt_delay),
+      timeout_(timeout),
+      stagger_(strand_),
+      deadline_(strand_)
+  {
+    attempts_.reserve(endpoints_.size());
+  }
+
+  void start()
+  {
+    net::dispatch(strand_, [self = this->shared_from_this()] {
+      if (self->endpoints_.empty())
+      {
+        self->finish(net::error::host_not_found, {});
+        return;
+      }
+      if (self->timeout_.count() > 0)
+      {
+        self->deadline_.expires_after(self->timeout_);
+        self->deadline_.async_wait([self](error_code ec) {
+          if (!ec && !self->done_)
+            self->finish(beast::error::timeout, {});
+        });
+      }
+      self->start_next();
+    });
+  }
+
+  void cancel() override
+  {
+    net::dispatch(strand_, [self = this->shared_from_this()] {
+      if (!self->done_)
+        self->finish(net::error::operation_aborted, {});
+    });
+  }
+
+private:
+  void start_next()
+  {
+    auto const index = attempts_.size();
+    attempts_.emplace_back(target_.get_executor());
+    ++pending_;
+    attempts_[index].async_connect(
+        endpoints_[index],
+        net::bind_executor(strand_,
+                           [self = this->shared_from_this(),
+                            index](error_code ec) {
+                             self->on_connect(index, ec);
+                           }));
+    if (attempts_.size() == endpoints_.size())
+      return;
+    stagger_.expires_after(attempt_delay_);
+    stagger_.async_wait([self = this->shared_from_this(),
+                         generation = ++generation_](error_code ec) {
+      if (!ec && !self->done_ && generation == self->generation_)
+        self->start_next();
+    });
+  }
+
+  void on_connect(std::size_t index, error_code ec)
+  {
+    --pending_;
+    if (done_)
+      return;
+    if (!ec)
+    {
+      target_ = std::move(attempts_[index]);
+      finish(ec, endpoints_[index]);
+      return;
+    }
+    last_error_ = ec;
+    if (attempts_.size() < endpoints_.size())
+    {
+      // the next address does not wait for the stagger delay
+      ++generation_;
+      stagger_.cancel();
+      start_next();
+    }
+    else if (pending_ == 0)
+      finish(last_error_, {});
+  }
+
+  void finish(error_code ec, tcp::endpoint endpoint)
+  {
+    done_ = true;
+    stagger_.cancel();
+    deadline_.cancel();
+    for (auto& attempt : attempts_)
+    {
+      error_code ignored;
+      attempt.close(ignored);
+    }
+    net::post(beast::bind_front_handler(std::move(*self_), ec, endpoint));
+    self_.reset();
+  }
+
+  Socket& target_;
+  std::optional<Self> self_;
+  net::strand<net::any_io_executor> strand_;
+  std::vector<tcp::endpoint> endpoints_;
+  std::vector<Socket> attempts_;
+  std::chrono::nanoseconds attempt_delay_;
+  std::chrono::nanoseconds timeout_;
+  net::steady_timer stagger_;
+  net::steady_timer deadline_;
+  std::size_t pending_ = 0;
+  std::size_t generation_ = 0;
+  error_code last_error_;
+  bool done_ = false;
+};
+
+template <typename Socket>
+struct happy_eyeballs_connect_op
+{
+  Socket& socket_;
+  std::vector<tcp::endpoint> endpoints_;
+  std::chrono::nanoseconds attempt_delay_;
+  std::chrono::nanoseconds timeout_;
+  std::weak_ptr<connection_race>& race_;
+
+  template <typename Self>
+  void operator()(Self& self)
+  {
+    auto& socket = socket_;
+    auto& race_handle = race_;
+    auto endpoints = std::move(endpoints_);
+    auto const attempt_delay = attempt_delay_;
+    auto const timeout = timeout_;
+    auto race = std::make_shared<happy_eyeballs_race<Socket, Self>>(
+        socket, std::move(self), std::move(endpoints), attempt_delay, timeout);
+    race_handle = race;
+    race->start();
+  }
+
+  template <typename Self>
+  void operator()(Self& self, error_code ec, tcp::endpoint endpoint)
+  {
+    self.complete(ec, endpoint);
+  }
+};
+
+// connects stream to the first of results which accepts the connection.
+// a timeout of zero leaves the race unbounded, race is set to a handle on
+// it for the time it runs.
+template <typename Stream, typename CompletionToken>
+auto async_happy_eyeballs_connect(Stream& stream,
+                                  tcp::resolver::results_type const& results,
+                                  std::chrono::nanoseconds attempt_delay,
+                                  std::chrono::nanoseconds timeout,
+                                  std::weak_ptr<connection_race>& race,
+                                  CompletionToken&& token)
+{
+  using socket_type = typename Stream::socket_type;
+  return net::async_compose<CompletionToken,
+                            void(error_code, tcp::endpoint)>(
+      happy_eyeballs_connect_op<socket_type>{
+          stream.socket(),
+          interleave_address_families(results),
+          attempt_delay,
+          timeout,
+          race},
+      token,
+      stream);
+}
+}
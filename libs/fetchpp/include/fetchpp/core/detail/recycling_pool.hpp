@@ -0,0 +1,222 @@
+#pragma once
+
+#include <boost/beast/http/fields.hpp>
+
+#include <fetchpp/alias/beast.hpp>
+#include <fetchpp/alias/error_code.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace fetchpp::detail
+{
+// keeps the memory of the objects it releases to hand it out again to
+// objects of the same size class, so that the per request state of a
+// session stops reaching the system allocator once it is warm.
+// asio may release handler memory outside of the strand of the operation,
+// hence the lock.
+class recycling_pool
+{
+public:
+  static constexpr std::size_t granularity = 64;
+  // larger blocks, and over-aligned ones, are not recycled
+  static constexpr std::size_t max_size = 4096;
+  static constexpr std::size_t max_cached_per_class = 64;
+
+  recycling_pool() = default;
+  ~recycling_pool();
+
+  recycling_pool(recycling_pool const&) = delete;
+  recycling_pool& operator=(recycling_pool const&) = delete;
+
+  void* allocate(std::size_t size,
+                 std::size_t alignment = alignof(std::max_align_t));
+  void deallocate(void* p,
+                  std::size_t size,
+                  std::size_t alignment = alignof(std::max_align_t)) noexcept;
+
+  // blocks requested from the system allocator
+  std::size_t allocations() const;
+  // blocks handed out again
+  std::size_t reuses() const;
+
+private:
+  struct free_block
+  {
+    free_block* next;
+  };
+  static constexpr std::size_t class_count = max_size / granularity;
+
+  mutable std::mutex mutex_;
+  std::array<free_block*, class_count> free_{};
+  std::array<std::size_t, class_count> cached_{};
+  std::size_t allocations_ = 0;
+  std::size_t reuses_ = 0;
+};
+
+// lets asio and beast allocate the memory of the operations started on
+// behalf of a handler from a pool
+template <typename T>
+class recycling_allocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  explicit recycling_allocator(std::shared_ptr<recycling_pool> pool) noexcept
+    : pool_(std::move(pool))
+  {
+  }
+
+  // a moved-from container must still be able to release its memory, the
+  // pool is shared rather than moved
+  recycling_allocator(recycling_allocator const&) noexcept = default;
+  recycling_allocator& operator=(recycling_allocator const&) noexcept =
+      default;
+
+  template <typename U>
+  recycling_allocator(recycling_allocator<U> const& other) noexcept
+    : pool_(other.pool_)
+  {
+  }
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(pool_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept
+  {
+    pool_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  template <typename U>
+  bool operator==(recycling_allocator<U> const& other) const noexcept
+  {
+    return pool_ == other.pool_;
+  }
+
+  template <typename U>
+  bool operator!=(recycling_allocator<U> const& other) const noexcept
+  {
+    return pool_ != other.pool_;
+  }
+
+private:
+  template <typename U>
+  friend class recycling_allocator;
+
+  std::shared_ptr<recycling_pool> pool_;
+};
+
+// header fields allocated from a pool: the fields a response frees before
+// the next one is read go back to the pool, and are taken from it again
+// rather than from the system allocator
+using pooled_fields = beast::http::basic_fields<recycling_allocator<char>>;
+
+template <typename T>
+struct pooled_delete
+{
+  std::shared_ptr<recycling_pool> pool;
+
+  void operator()(T* p) const noexcept
+  {
+    p->~T();
+    pool->deallocate(p, sizeof(T), alignof(T));
+  }
+};
+
+template <typename T>
+using pooled_ptr = std::unique_ptr<T, pooled_delete<T>>;
+
+template <typename T, typename... Args>
+pooled_ptr<T> make_pooled(std::shared_ptr<recycling_pool> pool,
+                          Args&&... args)
+{
+  auto* memory = pool->allocate(sizeof(T), alignof(T));
+  auto* object = new (memory) T(std::forward<Args>(args)...);
+  return pooled_ptr<T>(object, pooled_delete<T>{std::move(pool)});
+}
+
+// a type erased completion handler whose memory comes from a pool. The
+// memory is given back before the handler is invoked, and the operations
+// started with it allocate from the pool too
+class pooled_handler
+{
+public:
+  template <typename Handler>
+  pooled_handler(std::shared_ptr<recycling_pool> pool, Handler handler)
+    : pool_(std::move(pool))
+  {
+    auto* memory =
+        pool_->allocate(sizeof(holder<Handler>), alignof(holder<Handler>));
+    impl_.reset(new (memory) holder<Handler>(std::move(handler), pool_));
+  }
+
+  using allocator_type = recycling_allocator<void>;
+  allocator_type get_allocator() const noexcept
+  {
+    return allocator_type(pool_);
+  }
+
+  void operator()(error_code ec)
+  {
+    impl_.release()->complete(ec);
+  }
+
+private:
+  struct base
+  {
+    // invokes the handler once its memory is released
+    virtual void complete(error_code ec) = 0;
+    virtual void release() noexcept = 0;
+
+  protected:
+    ~base() = default;
+  };
+
+  template <typename Handler>
+  struct holder final : base
+  {
+    Handler handler_;
+    std::shared_ptr<recycling_pool> pool_;
+
+    holder(Handler handler, std::shared_ptr<recycling_pool> pool)
+      : handler_(std::move(handler)), pool_(std::move(pool))
+    {
+    }
+
+    void complete(error_code ec) override
+    {
+      auto handler = std::move(handler_);
+      release();
+      handler(ec);
+    }
+
+    void release() noexcept override
+    {
+      auto pool = std::move(pool_);
+      this->~holder();
+      pool->deallocate(this, sizeof(holder), alignof(holder));
+    }
+  };
+
+  struct releaser
+  {
+    void operator()(base* b) const noexcept
+    {
+      b->release();
+    }
+  };
+
+  std::shared_ptr<recycling_pool> pool_;
+  std::unique_ptr<base, releaser> impl_;
+};
+}
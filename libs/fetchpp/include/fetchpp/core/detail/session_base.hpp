@@ -1,12 +1,22 @@
 #pragma once
 
+#include <fetchpp/core/detail/recycling_pool.hpp>
+#include <fetchpp/core/retry_policy.hpp>
+
 #include <boost/asio/executor.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/beast/core/error.hpp>
 
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
-#include <queue>
+#include <optional>
+#include <random>
 
+#include <fetchpp/alias/error_code.hpp>
 #include <fetchpp/alias/net.hpp>
 
 namespace fetchpp::detail
@@ -14,9 +24,45 @@ namespace fetchpp::detail
 struct task
 {
   virtual ~task() = 0;
-  using ptr_t = std::unique_ptr<task>;
+  struct deleter
+  {
+    void operator()(task* t) const noexcept;
+  };
+  using ptr_t = std::unique_ptr<task, deleter>;
+  // releases the task, deletes it unless it comes from a pool
+  virtual void destroy() noexcept;
   virtual void run() = 0;
   virtual void cancel() = 0;
+  // interrupts a started task, which then completes with
+  // net::error::operation_aborted
+  virtual void abort();
+
+  // pipelining support, only called when pipelinable() returns true.
+  // handlers are invoked on the session's internal executor
+  using handler_t = pooled_handler;
+  virtual bool pipelinable() const;
+  virtual void async_write(handler_t handler);
+  virtual void async_read(handler_t handler);
+  // whether the connection can be reused once the response is read
+  virtual bool keep_alive() const;
+  // whether the task was aborted while it was processed
+  virtual bool cancelled() const;
+  // called when a pipelined exchange of the task failed with ec: how long
+  // to wait before the task is processed again, nullopt when it fails for
+  // good. Accounts for the attempt
+  virtual std::optional<std::chrono::nanoseconds> next_retry_delay(
+      error_code ec);
+  // also used to complete tasks expiring in the queue
+  virtual void complete(error_code ec);
+
+  // higher priorities are run first
+  int priority = 0;
+  // managed by the session
+  std::uint64_t id = 0;
+  std::chrono::steady_clock::time_point queued_at;
+  // a started task is being processed and can no longer leave the queue
+  bool started = false;
+  std::optional<net::steady_timer> expiry;
 };
 
 struct session_base
@@ -39,11 +85,49 @@ struct session_base
 
   std::size_t pending_tasks() const;
   bool has_tasks() const;
-  void push_task(detail::task::ptr_t t);
+  using clock_type = std::chrono::steady_clock;
+
+  // a task which has not started by its deadline is completed with
+  // beast::error::timeout and removed from the queue
+  std::uint64_t push_task(
+      detail::task::ptr_t t,
+      std::optional<clock_type::time_point> deadline = std::nullopt);
+  // a queued task is removed and cancelled, a started one is aborted
+  void cancel_task(std::uint64_t id);
+  // runs the task of highest priority unless the front one has already
+  // started
   void process_task();
   void pop_task();
   void cancel_all_tasks();
   void advance_task();
+  task& front_task();
+  task& task_at(std::size_t index);
+
+  // how many requests can be written before reading their responses, 1
+  // disables HTTP/1.1 pipelining
+  std::size_t pipeline_depth() const;
+  void set_pipeline_depth(std::size_t depth);
+  void disable_pipelining();
+  // the number of tasks which can be pipelined from the front of the queue
+  std::size_t pipeline_batch() const;
+  // the first count tasks, written but left unanswered, are sent again from
+  // the start
+  void restart_tasks(std::size_t count);
+
+  // each period spent in the queue raises the priority of a task by one, so
+  // that low priority tasks are not starved. Zero disables aging
+  std::chrono::nanoseconds priority_aging() const;
+  void set_priority_aging(std::chrono::nanoseconds period);
+
+  // a reservation announces a task that is about to be pushed, so that the
+  // session is not considered idle in the meantime
+  void reserve();
+  void release();
+  std::size_t reserved() const;
+  bool idle() const;
+  clock_type::time_point last_activity() const;
+  // called each time the session runs out of tasks
+  void on_idle(std::function<void()> callback);
 
   template <typename CompletionToken>
   auto async_wait_for_tasks_cancellation(CompletionToken&& token)
@@ -53,16 +137,69 @@ struct session_base
     return this->timer_.async_wait(std::forward<CompletionToken>(token));
   }
 
+  fetchpp::retry_policy const& get_retry_policy() const;
+  // without a budget, the session gets one of its own
+  void set_retry_policy(fetchpp::retry_policy policy,
+                        std::shared_ptr<retry_budget> budget = nullptr);
+  // accounts for a new request in the retry budget, each pushed task is
+  // counted
+  void count_request();
+  // how long to wait before the next attempt of a request, nullopt when it
+  // must not be retried
+  std::optional<std::chrono::nanoseconds> retry_delay(failure_kind kind,
+                                                      error_code ec,
+                                                      std::size_t attempt,
+                                                      bool idempotent);
+  std::size_t retries() const;
+
+  template <typename CompletionToken>
+  auto async_wait_for_retry(std::chrono::nanoseconds delay,
+                            CompletionToken&& token)
+  {
+    this->retry_timer_.expires_after(delay);
+    return this->retry_timer_.async_wait(
+        std::forward<CompletionToken>(token));
+  }
+  void cancel_retry();
+
   void set_running(bool new_state);
+  // a failed session stopped by itself after an error, unlike one stopped
+  // with async_stop
+  void set_failed();
+  bool failed() const;
+
+  // the memory of the tasks and of the operations run for them, recycled
+  // from one request to the next
+  std::shared_ptr<recycling_pool> const& memory_pool() const;
+  // the number of blocks the pool had to request from the system
+  std::size_t allocations() const;
 
   // we don't want to pass as an io object
   auto get_executor() -> internal_executor_type = delete;
 
 private:
+  void expire_task(std::uint64_t id);
+  // orders the queue by effective priority, queueing order breaking ties
+  void schedule_tasks();
+
   internal_executor_type strand_;
   net::steady_timer timer_;
-  std::queue<detail::task::ptr_t> tasks_;
+  net::steady_timer retry_timer_;
+  // declared before the tasks, which give their memory back on destruction
+  std::shared_ptr<recycling_pool> pool_;
+  std::deque<detail::task::ptr_t> tasks_;
+  std::size_t pipeline_depth_ = 1;
+  std::chrono::nanoseconds priority_aging_ = std::chrono::seconds(1);
+  std::size_t reserved_ = 0;
+  std::uint64_t last_task_id_ = 0;
+  clock_type::time_point last_activity_ = clock_type::now();
+  std::function<void()> on_idle_;
+  fetchpp::retry_policy retry_policy_;
+  std::shared_ptr<retry_budget> retry_budget_;
+  std::minstd_rand random_;
+  std::size_t retries_ = 0;
   bool is_running_ = true;
+  bool is_failed_ = false;
 };
 
 }
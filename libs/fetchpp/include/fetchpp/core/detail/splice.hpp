@@ -0,0 +1,52 @@
+#pragma once
+
+#include <boost/beast/core/error.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace fetchpp::detail
+{
+// whether send_file can read from fd: a regular file, on a system
+// supporting sendfile
+bool can_send_file(int fd);
+
+// sends up to size bytes of the file from offset, which is advanced, the
+// kernel does not copy them to user space. Fails with
+// net::error::would_block when the socket cannot take more yet
+std::size_t send_file(int socket,
+                      int fd,
+                      std::uint64_t& offset,
+                      std::size_t size,
+                      error_code& ec);
+
+// whether socket_splicer can write to fd: a regular file, not opened in
+// append mode, on a system supporting splice
+bool can_splice_to(int fd);
+
+// moves bytes from a socket to a file through a pipe, the kernel does not
+// copy them to user space
+class socket_splicer
+{
+public:
+  // bytes moved at most per transfer, the capacity of a pipe
+  static constexpr std::size_t chunk_size = 64 * 1024;
+
+  socket_splicer() = default;
+  ~socket_splicer();
+
+  socket_splicer(socket_splicer const&) = delete;
+  socket_splicer& operator=(socket_splicer const&) = delete;
+
+  // moves what the socket has to read, up to size bytes. Fails with
+  // net::error::would_block when there is nothing to read yet and returns 0
+  // when the peer closed the connection
+  std::size_t transfer(int socket, int fd, std::size_t size, error_code& ec);
+
+private:
+  std::array<int, 2> pipe_ = {-1, -1};
+};
+}
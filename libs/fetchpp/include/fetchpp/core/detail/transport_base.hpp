@@ -0,0 +1,132 @@
+#pragma once
+
+#include <fetchpp/core/dns_cache.hpp>
+
+#include <fetchpp/core/detail/happy_eyeballs.hpp>
+#include <fetchpp/core/detail/recycling_pool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+namespace fetchpp
+{
+class ssl_session_cache;
+
+namespace detail
+{
+// what the transports hold besides their stream: the caches and pool they
+// are given by their session, their timeouts, and whether they run
+class transport_base
+{
+public:
+  explicit transport_base(std::chrono::nanoseconds timeout) : timeout_(timeout)
+  {
+  }
+
+  // resolutions go through this cache when set
+  void set_dns_cache(std::shared_ptr<fetchpp::dns_cache> cache)
+  {
+    dns_cache_ = std::move(cache);
+  }
+
+  std::shared_ptr<fetchpp::dns_cache> const& get_dns_cache() const
+  {
+    return dns_cache_;
+  }
+
+  // the response parsers of the connection are allocated from this pool
+  std::shared_ptr<recycling_pool> const& memory_pool() const
+  {
+    return memory_pool_;
+  }
+
+  void set_memory_pool(std::shared_ptr<recycling_pool> pool)
+  {
+    memory_pool_ = std::move(pool);
+  }
+
+  // TLS handshakes resume the sessions of this cache when set
+  void set_ssl_session_cache(
+      std::shared_ptr<fetchpp::ssl_session_cache> cache)
+  {
+    ssl_session_cache_ = std::move(cache);
+  }
+
+  std::shared_ptr<fetchpp::ssl_session_cache> const& get_ssl_session_cache()
+      const
+  {
+    return ssl_session_cache_;
+  }
+
+  // the operations started from now on must be done by this time point, in
+  // addition to the timeout of the transport
+  void set_deadline(
+      std::optional<std::chrono::steady_clock::time_point> deadline)
+  {
+    deadline_ = deadline;
+  }
+
+  // the transport timeout, shortened by the deadline
+  std::chrono::nanoseconds operation_timeout() const
+  {
+    if (!deadline_)
+      return timeout_;
+    auto const left = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        *deadline_ - std::chrono::steady_clock::now());
+    return std::max(std::min(left, timeout_), std::chrono::nanoseconds(1));
+  }
+
+  auto const& timeout() const
+  {
+    return timeout_;
+  }
+
+  // delay between the staggered attempts of a connection race
+  std::chrono::nanoseconds connection_attempt_delay() const
+  {
+    return connection_attempt_delay_;
+  }
+
+  void set_connection_attempt_delay(std::chrono::nanoseconds delay)
+  {
+    connection_attempt_delay_ = delay;
+  }
+
+  // the race of the pending connection, if any
+  std::weak_ptr<detail::connection_race>& connection_race()
+  {
+    return connection_race_;
+  }
+
+  void cancel_connection_race()
+  {
+    if (auto race = connection_race_.lock())
+      race->cancel();
+  }
+
+  void set_running(bool r = true)
+  {
+    running_ = r;
+  }
+
+  bool is_running() const
+  {
+    return running_;
+  }
+
+private:
+  std::shared_ptr<fetchpp::dns_cache> dns_cache_;
+  std::shared_ptr<recycling_pool> memory_pool_ =
+      std::make_shared<recycling_pool>();
+  std::shared_ptr<fetchpp::ssl_session_cache> ssl_session_cache_;
+  std::chrono::nanoseconds timeout_;
+  std::optional<std::chrono::steady_clock::time_point> deadline_;
+  std::chrono::nanoseconds connection_attempt_delay_ =
+      std::chrono::milliseconds(250);
+  std::weak_ptr<detail::connection_race> connection_race_;
+  bool running_ = true;
+};
+}
+}
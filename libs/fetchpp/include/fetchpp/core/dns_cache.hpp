@@ -0,0 +1,147 @@
+#pragma once
+
+#include <fetchpp/core/detail/coroutine.hpp>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/compose.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/error.hpp>
+
+#include <fetchpp/alias/beast.hpp>
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/net.hpp>
+#include <fetchpp/alias/tcp.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace fetchpp
+{
+// resolution results shared by the transports of a client.
+// successful resolutions are kept for ttl, failures for negative_ttl. An
+// entry used during the last quarter of its lifetime is refreshed in the
+// background so that connections do not wait for it to expire. Expired
+// entries are dropped when a new one is stored, and at most max_entries are
+// kept, the ones closest to expiry are evicted first.
+class dns_cache : public std::enable_shared_from_this<dns_cache>
+{
+public:
+  using clock_type = std::chrono::steady_clock;
+  using results_type = tcp::resolver::results_type;
+
+  struct entry
+  {
+    error_code ec;
+    results_type results;
+  };
+
+  explicit dns_cache(net::any_io_executor ex,
+                     std::chrono::nanoseconds ttl = std::chrono::seconds(60),
+                     std::chrono::nanoseconds negative_ttl =
+                         std::chrono::seconds(5),
+                     std::size_t max_entries = 1024);
+
+  std::optional<entry> lookup(std::string const& host, std::uint16_t port);
+  void store(std::string const& host,
+             std::uint16_t port,
+             error_code ec,
+             results_type results);
+  void clear();
+
+  std::chrono::nanoseconds ttl() const;
+  std::chrono::nanoseconds negative_ttl() const;
+  std::size_t max_entries() const;
+  std::size_t size() const;
+  std::size_t hits() const;
+  std::size_t misses() const;
+
+private:
+  struct cached_entry
+  {
+    entry value;
+    clock_type::time_point stored_at;
+    clock_type::time_point expires_at;
+    bool refreshing = false;
+  };
+
+  void refresh(std::string const& host, std::uint16_t port);
+  // must be called with mutex_ locked
+  void evict(clock_type::time_point now);
+
+  net::any_io_executor ex_;
+  std::chrono::nanoseconds ttl_;
+  std::chrono::nanoseconds negative_ttl_;
+  std::size_t max_entries_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, cached_entry> entries_;
+  std::atomic<std::size_t> hits_{0};
+  std::atomic<std::size_t> misses_{0};
+};
+
+namespace detail
+{
+template <typename Resolver>
+struct cached_resolve_op
+{
+  Resolver& resolver_;
+  dns_cache* cache_;
+  std::string host_;
+  std::uint16_t port_;
+  std::optional<dns_cache::entry> cached_ = std::nullopt;
+  net::coroutine coro_ = {};
+
+  template <typename Self>
+  void operator()(Self& self,
+                  error_code ec = {},
+                  dns_cache::results_type results = {})
+  {
+    FETCHPP_REENTER(coro_)
+    {
+      if (cache_)
+        cached_ = cache_->lookup(host_, port_);
+      if (cached_.has_value())
+      {
+        // the entry stays in the op, moving self would move it before it is
+        // bound to the handler
+        FETCHPP_YIELD net::post(std::move(self));
+        self.complete(cached_->ec, std::move(cached_->results));
+        return;
+      }
+      FETCHPP_YIELD resolver_.async_resolve(
+          host_,
+          std::to_string(port_),
+          net::ip::resolver_base::numeric_service,
+          std::move(self));
+      if (cache_ && ec != net::error::operation_aborted)
+        cache_->store(host_, port_, ec, results);
+      self.complete(ec, std::move(results));
+    }
+  }
+};
+}
+
+// resolves through the cache when there is one, the resolver is only used
+// on cache misses
+template <typename CompletionToken>
+auto async_resolve(tcp::resolver& resolver,
+                   dns_cache* cache,
+                   std::string host,
+                   std::uint16_t port,
+                   CompletionToken&& token)
+{
+  return net::async_compose<CompletionToken,
+                            void(error_code, dns_cache::results_type)>(
+      detail::cached_resolve_op<tcp::resolver>{
+          resolver, cache, std::move(host), port},
+      token,
+      resolver);
+}
+}
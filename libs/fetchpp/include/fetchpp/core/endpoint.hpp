@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <type_traits>
 
@@ -22,6 +24,8 @@ private:
   std::string domain_;
   std::uint16_t port_;
 };
+
+std::size_t hash_value(base_endpoint const&);
 }
 
 template <bool isSecure>
@@ -82,4 +86,27 @@ private:
 
 bool operator==(tunnel_endpoint const&, tunnel_endpoint const&);
 bool operator!=(tunnel_endpoint const&, tunnel_endpoint const&);
+
+std::size_t hash_value(tunnel_endpoint const&);
+}
+
+namespace std
+{
+template <bool isSecure>
+struct hash<fetchpp::basic_endpoint<isSecure>>
+{
+  std::size_t operator()(fetchpp::basic_endpoint<isSecure> const& ep) const
+  {
+    return fetchpp::detail::hash_value(ep);
+  }
+};
+
+template <>
+struct hash<fetchpp::tunnel_endpoint>
+{
+  std::size_t operator()(fetchpp::tunnel_endpoint const& ep) const
+  {
+    return fetchpp::hash_value(ep);
+  }
+};
 }
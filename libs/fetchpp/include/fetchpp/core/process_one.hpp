@@ -3,9 +3,23 @@
 #include <fetchpp/core/transport_traits.hpp>
 
 #include <fetchpp/core/detail/coroutine.hpp>
+#include <fetchpp/core/detail/recycling_pool.hpp>
+#include <fetchpp/core/detail/splice.hpp>
+#include <fetchpp/http/compressing_body.hpp>
+#include <fetchpp/http/fd_body.hpp>
+#include <fetchpp/http/fd_source_body.hpp>
+#include <fetchpp/http/streaming_body.hpp>
 
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/bind_executor.hpp>
 #include <boost/asio/compose.hpp>
+#include <boost/asio/socket_base.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/http/error.hpp>
 #include <boost/beast/http/read.hpp>
+#include <boost/beast/http/serializer.hpp>
 #include <boost/beast/http/write.hpp>
 
 #include <fetchpp/alias/beast.hpp>
@@ -13,17 +27,27 @@
 #include <fetchpp/alias/http.hpp>
 #include <fetchpp/alias/net.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
 namespace fetchpp
 {
 template <typename AsyncStream,
           typename Buffer,
           typename Request,
           typename Body,
+          typename Allocator,
           typename CompletionToken>
 auto async_process_one(AsyncStream& stream,
                        Buffer& buffer,
                        Request& request,
-                       beast::http::response_parser<Body>& parser,
+                       beast::http::response_parser<Body, Allocator>& parser,
                        CompletionToken&& token) ->
     typename net::async_result<std::decay_t<CompletionToken>,
                                void(error_code)>::return_type;
@@ -52,8 +76,175 @@ auto async_process_one(AsyncTransport& transport,
     typename net::async_result<std::decay_t<CompletionToken>,
                                void(error_code)>::return_type;
 
+// write a request, or read its response, on a transport whose connection is
+// already established. Used to pipeline several requests on one connection
+template <typename AsyncTransport, typename Request, typename CompletionToken>
+auto async_write_request(AsyncTransport& transport,
+                         Request& request,
+                         CompletionToken&& token) ->
+    typename net::async_result<std::decay_t<CompletionToken>,
+                               void(error_code)>::return_type;
+
+template <typename AsyncTransport,
+          typename Request,
+          typename Response,
+          typename CompletionToken>
+auto async_read_response(AsyncTransport& transport,
+                         Request const& request,
+                         Response& response,
+                         CompletionToken&& token) ->
+    typename net::async_result<std::decay_t<CompletionToken>,
+                               void(error_code)>::return_type;
+
 namespace process_one::detail
 {
+// the parser builds the message in the header storage of the response
+template <typename Response>
+using response_parser_t = beast::http::response_parser<
+    typename Response::body_type,
+    typename Response::fields_type::allocator_type>;
+
+template <typename Value, typename = void>
+struct has_clear : std::false_type
+{
+};
+
+template <typename Value>
+struct has_clear<Value, std::void_t<decltype(std::declval<Value&>().clear())>>
+  : std::true_type
+{
+};
+
+// empties a response before a parser takes it over. The body keeps its
+// capacity. The header fields are freed, and allocated again by the next
+// response unless they come from a pool, see detail::pooled_fields
+template <typename Response>
+void recycle_response(Response& res)
+{
+  static_cast<typename Response::fields_type&>(res).clear();
+  if constexpr (has_clear<typename Response::body_type::value_type>::value)
+    res.body().clear();
+}
+
+template <typename Request, typename = void>
+struct has_body_limit : std::false_type
+{
+};
+
+template <typename Request>
+struct has_body_limit<
+    Request,
+    std::void_t<decltype(std::declval<Request const&>().body_limit())>>
+  : std::true_type
+{
+};
+
+// a body which is not kept in memory has no limit by default
+template <typename Body>
+constexpr bool streamed_body = std::is_same_v<Body, http::streaming_body> ||
+                               std::is_same_v<Body, http::fd_body>;
+
+template <typename Body, typename Request>
+std::optional<std::uint64_t> request_body_limit(Request const& req)
+{
+  if constexpr (has_body_limit<Request>::value)
+  {
+    if (streamed_body<Body> && !req.body_limit_is_set())
+      return std::nullopt;
+    return req.body_limit();
+  }
+  else if constexpr (streamed_body<Body>)
+    return std::nullopt;
+  else
+    return 80 * 1024 * 1024;
+}
+
+template <typename Value, typename = void>
+struct has_max_size : std::false_type
+{
+};
+
+template <typename Value>
+struct has_max_size<
+    Value,
+    std::void_t<decltype(std::declval<Value&>().max_size(std::size_t{}))>>
+  : std::true_type
+{
+};
+
+template <typename Request, typename = void>
+struct has_accepts_compressed : std::false_type
+{
+};
+
+template <typename Request>
+struct has_accepts_compressed<
+    Request,
+    std::void_t<decltype(std::declval<Request const&>().accepts_compressed())>>
+  : std::true_type
+{
+};
+
+template <typename Value, typename = void>
+struct has_decode_content : std::false_type
+{
+};
+
+template <typename Value>
+struct has_decode_content<
+    Value,
+    std::void_t<decltype(std::declval<Value&>().decode_content(bool{}))>>
+  : std::true_type
+{
+};
+
+template <typename Parser, typename Request>
+void prepare_parser(Parser& parser, Request const& req)
+{
+  auto const limit =
+      request_body_limit<typename Parser::value_type::body_type>(req);
+  if (limit)
+    parser.body_limit(*limit);
+  else
+    parser.body_limit(boost::none);
+  // the parser limit counts the encoded body, a decoding body bounds what
+  // it decodes to with the size of its value
+  using body_value_type = typename Parser::value_type::body_type::value_type;
+  if constexpr (has_max_size<body_value_type>::value)
+  {
+    constexpr auto unbounded = std::numeric_limits<std::size_t>::max();
+    parser.get().body().max_size(
+        limit ? static_cast<std::size_t>(std::min<std::uint64_t>(*limit,
+                                                                 unbounded)) :
+                unbounded);
+  }
+  // a compressed body is only decoded when the request asked for one
+  if constexpr (has_decode_content<body_value_type>::value)
+  {
+    if constexpr (has_accepts_compressed<Request>::value)
+      parser.get().body().decode_content(req.accepts_compressed());
+    else
+      parser.get().body().decode_content(false);
+  }
+  if (req.method() == beast::http::verb::connect ||
+      req.method() == beast::http::verb::head)
+    parser.skip(true);
+}
+
+// beast parsers cannot be reset, a new one is built for each exchange but its
+// memory comes from the pool of the transport. The parser takes the response
+// over until the exchange completes
+template <typename Parser, typename Request, typename Response>
+auto make_parser(std::shared_ptr<fetchpp::detail::recycling_pool> const& pool,
+                 Request const& req,
+                 Response& res)
+{
+  recycle_response(res);
+  auto parser = fetchpp::detail::make_pooled<Parser>(pool, std::move(res));
+  prepare_parser(*parser, req);
+  return parser;
+}
+
 template <typename AsyncStream,
           typename Buffer,
           typename ResponseParser,
@@ -78,6 +269,237 @@ auto run_async_write(AsyncStream& stream,
   return http::async_write(stream, request, std::move(token));
 }
 
+// the transport timeout does not cover the waits on the socket itself, they
+// are cancelled when this timer expires
+class socket_deadline
+{
+public:
+  template <typename Socket, typename Executor>
+  socket_deadline(Socket& socket,
+                  Executor const& ex,
+                  std::chrono::nanoseconds timeout)
+    : timer_(socket.get_executor(), timeout)
+  {
+    timer_.async_wait(
+        net::bind_executor(ex, [&socket](error_code error) {
+          if (!error)
+            socket.cancel(error);
+        }));
+  }
+
+  ~socket_deadline()
+  {
+    timer_.cancel();
+  }
+
+  bool expired() const
+  {
+    return timer_.expiry() <= net::steady_timer::clock_type::now();
+  }
+
+private:
+  net::steady_timer timer_;
+};
+
+// bodies move between files and plain tcp connections without going
+// through user space
+template <typename AsyncTransport>
+constexpr bool is_plain_transport = std::is_same_v<
+    beast::lowest_layer_type<typename AsyncTransport::next_layer_type>,
+    typename AsyncTransport::next_layer_type>;
+
+template <typename AsyncTransport, typename Request>
+constexpr bool sends_file =
+    std::is_same_v<typename Request::body_type, http::fd_source_body> &&
+    is_plain_transport<AsyncTransport>;
+
+// the header is written by beast, the body is sent from the file by the
+// kernel
+template <typename AsyncTransport, typename Request>
+struct sendfile_write_op
+{
+  AsyncTransport& transport_;
+  Request& req_;
+  using serializer_t =
+      beast::http::request_serializer<typename Request::body_type,
+                                      typename Request::fields_type>;
+  fetchpp::detail::pooled_ptr<serializer_t> serializer_;
+  fetchpp::detail::pooled_ptr<socket_deadline> deadline_ = nullptr;
+  std::uint64_t offset_ = 0;
+  std::uint64_t remaining_ = 0;
+  std::size_t written_ = 0;
+  net::coroutine coro_ = net::coroutine{};
+
+  sendfile_write_op(AsyncTransport& transport, Request& req)
+    : transport_(transport),
+      req_(req),
+      serializer_(fetchpp::detail::make_pooled<serializer_t>(
+          transport.memory_pool(), req))
+  {
+  }
+
+  auto& socket()
+  {
+    return beast::get_lowest_layer(transport_.next_layer()).socket();
+  }
+
+  // sends what the socket can take, net::error::would_block asks to wait
+  // for it
+  error_code transfer()
+  {
+    error_code ec;
+    auto const sent = fetchpp::detail::send_file(
+        socket().native_handle(),
+        req_.body().fd,
+        offset_,
+        static_cast<std::size_t>(std::min<std::uint64_t>(
+            remaining_, std::numeric_limits<std::size_t>::max())),
+        ec);
+    remaining_ -= sent;
+    written_ += sent;
+    // the file is shorter than the body announced
+    if (!ec && sent == 0)
+      ec = boost::system::errc::make_error_code(boost::system::errc::io_error);
+    return ec;
+  }
+
+  template <typename Self>
+  void operator()(Self& self, error_code ec = error_code{}, std::size_t n = 0)
+  {
+    if (ec == net::error::operation_aborted && deadline_ &&
+        deadline_->expired())
+      ec = beast::error::timeout;
+    written_ += n;
+    if (ec)
+    {
+      deadline_.reset();
+      self.complete(ec, written_);
+      return;
+    }
+    FETCHPP_REENTER(coro_)
+    {
+      FETCHPP_YIELD beast::http::async_write_header(
+          transport_.next_layer(), *serializer_, std::move(self));
+      if (!fetchpp::detail::can_send_file(req_.body().fd))
+      {
+        FETCHPP_YIELD beast::http::async_write(
+            transport_.next_layer(), *serializer_, std::move(self));
+        self.complete(ec, written_);
+        return;
+      }
+      offset_ = req_.body().offset;
+      remaining_ = req_.body().size;
+      deadline_ = fetchpp::detail::make_pooled<socket_deadline>(
+          transport_.memory_pool(),
+          socket(),
+          net::get_associated_executor(self, transport_.get_executor()),
+          transport_.operation_timeout());
+      while (remaining_ > 0)
+      {
+        ec = transfer();
+        if (ec == net::error::would_block)
+        {
+          FETCHPP_YIELD socket().async_wait(net::socket_base::wait_write,
+                                            std::move(self));
+        }
+        else if (ec)
+        {
+          break;
+        }
+      }
+      deadline_.reset();
+      self.complete(ec, written_);
+    }
+  }
+};
+
+template <typename Request, typename = void>
+struct compresses_body : std::false_type
+{
+};
+
+template <typename Request>
+struct compresses_body<
+    Request,
+    std::void_t<
+        decltype(std::declval<Request const&>().compression_threshold()),
+        decltype(std::declval<Request const&>().body().cdata())>>
+  : std::true_type
+{
+};
+
+template <typename Request>
+bool should_compress(Request const& req)
+{
+  auto const threshold = req.compression_threshold();
+  // a body of unknown size is sent chunked, which HTTP/1.0 lacks
+  return threshold && req.version() >= 11 &&
+         req.body().size() >= *threshold &&
+         req.find(beast::http::field::content_encoding) == req.end();
+}
+
+// the body is gzipped into a message sharing its header, the request
+// itself is left as it is for a retry
+template <typename AsyncTransport, typename Request>
+struct compressing_write_op
+{
+  using body_t = http::compressing_body<
+      typename Request::body_type::value_type::const_buffers_type>;
+  using message_t =
+      beast::http::request<body_t, typename Request::fields_type>;
+
+  AsyncTransport& transport_;
+  Request& req_;
+  fetchpp::detail::pooled_ptr<message_t> compressed_ = nullptr;
+  net::coroutine coro_ = net::coroutine{};
+
+  template <typename Self>
+  void operator()(Self& self, error_code ec = error_code{}, std::size_t n = 0)
+  {
+    FETCHPP_REENTER(coro_)
+    {
+      if (!should_compress(req_))
+      {
+        FETCHPP_YIELD run_async_write(
+            transport_.next_layer(), req_, std::move(self));
+        self.complete(ec, n);
+        return;
+      }
+      compressed_ = fetchpp::detail::make_pooled<message_t>(
+          transport_.memory_pool(),
+          static_cast<typename Request::header_type const&>(req_),
+          req_.body().cdata());
+      compressed_->set(beast::http::field::content_encoding, "gzip");
+      compressed_->prepare_payload();
+      FETCHPP_YIELD run_async_write(
+          transport_.next_layer(), *compressed_, std::move(self));
+      compressed_.reset();
+      self.complete(ec, n);
+    }
+  }
+};
+
+template <typename AsyncTransport, typename Request, typename CompletionToken>
+auto async_write_message(AsyncTransport& transport,
+                         Request& request,
+                         CompletionToken&& token)
+{
+  if constexpr (sends_file<AsyncTransport, Request>)
+    return net::async_compose<CompletionToken, void(error_code, std::size_t)>(
+        sendfile_write_op<AsyncTransport, Request>{transport, request},
+        token,
+        transport);
+  else if constexpr (compresses_body<Request>::value)
+    return net::async_compose<CompletionToken, void(error_code, std::size_t)>(
+        compressing_write_op<AsyncTransport, Request>{transport, request},
+        token,
+        transport);
+  else
+    return run_async_write(transport.next_layer(),
+                           request,
+                           std::forward<CompletionToken>(token));
+}
+
 template <typename AsyncStream,
           typename Request,
           typename ResponseParser,
@@ -124,18 +546,16 @@ struct stream_op
   Request& req_;
   Response& res_;
   Buffer& buffer_;
-  using parser_t = beast::http::response_parser<typename Response::body_type>;
+  using parser_t = response_parser_t<Response>;
   std::unique_ptr<parser_t> parser_;
   net::coroutine coro_ = net::coroutine{};
 
   stream_op(AsyncStream& stream, Request& req, Response& res, Buffer& buf)
-    : stream_(stream),
-      req_(req),
-      res_(res),
-      buffer_(buf),
-      parser_(std::make_unique<parser_t>())
+    : stream_(stream), req_(req), res_(res), buffer_(buf)
   {
-    parser_->body_limit(83'886'080); // 80MiB
+    recycle_response(res_);
+    parser_ = std::make_unique<parser_t>(std::move(res_));
+    prepare_parser(*parser_, req_);
   }
 
   template <typename Self>
@@ -143,19 +563,16 @@ struct stream_op
   {
     if (ec)
     {
+      res_ = parser_->release();
       self.complete(ec);
       return;
     }
 
     FETCHPP_REENTER(coro_)
     {
-      if (req_.method() == beast::http::verb::connect ||
-          req_.method() == beast::http::verb::head)
-        parser_->skip(true);
-
       FETCHPP_YIELD async_process_one(
           stream_, buffer_, req_, *parser_, std::move(self));
-      res_ = std::move(parser_->release());
+      res_ = parser_->release();
       self.complete(ec);
     }
   }
@@ -167,22 +584,298 @@ struct transport_op
   AsyncTransport& transport_;
   Request& req_;
   Response& res_;
-  using parser_t = beast::http::response_parser<typename Response::body_type>;
-  std::unique_ptr<parser_t> parser_;
+  using parser_t = response_parser_t<Response>;
+  fetchpp::detail::pooled_ptr<parser_t> parser_ = nullptr;
   net::coroutine coro_ = net::coroutine{};
 
   transport_op(AsyncTransport& transport, Request& req, Response& res)
-    : transport_(transport),
-      req_(req),
-      res_(res),
-      parser_(std::make_unique<parser_t>())
+    : transport_(transport), req_(req), res_(res)
+  {
+  }
+
+  template <typename Self>
+  void operator()(Self& self, error_code ec = error_code{}, std::size_t = 0)
+  {
+    if (ec || !transport_.is_running())
+    {
+      transport_.cancel_timer();
+      // the response, and what it carries, is handed back as it was read
+      if (parser_)
+        res_ = parser_->release();
+      self.complete(ec ? ec : error_code(net::error::operation_aborted));
+      return;
+    }
+    FETCHPP_REENTER(coro_)
+    {
+      transport_.setup_timer();
+      FETCHPP_YIELD detail::async_write_message(
+          transport_, req_, std::move(self));
+      parser_ = make_parser<parser_t>(transport_.memory_pool(), req_, res_);
+      FETCHPP_YIELD detail::run_async_read(transport_.next_layer(),
+                                           transport_.buffer(),
+                                           *parser_,
+                                           std::move(self));
+      res_ = parser_->release();
+      transport_.cancel_timer();
+      self.complete(ec);
+    }
+  }
+};
+
+// the body of a response written to a file is moved by the kernel from a
+// plain tcp connection to the file, the parser only reads the header and
+// the part of the body buffered with it
+template <typename AsyncTransport, typename Response>
+constexpr bool splices_body =
+    std::is_same_v<typename Response::body_type, http::fd_body> &&
+    is_plain_transport<AsyncTransport>;
+
+template <typename AsyncTransport, typename Request, typename Response>
+struct splice_transport_op
+{
+  AsyncTransport& transport_;
+  Request& req_;
+  Response& res_;
+  using parser_t = response_parser_t<Response>;
+  fetchpp::detail::pooled_ptr<parser_t> parser_ = nullptr;
+  fetchpp::detail::pooled_ptr<fetchpp::detail::socket_splicer> splicer_ =
+      nullptr;
+  fetchpp::detail::pooled_ptr<socket_deadline> deadline_ = nullptr;
+  std::uint64_t remaining_ = 0;
+  net::coroutine coro_ = net::coroutine{};
+
+  splice_transport_op(AsyncTransport& transport, Request& req, Response& res)
+    : transport_(transport), req_(req), res_(res)
+  {
+  }
+
+  auto& socket()
+  {
+    return beast::get_lowest_layer(transport_.next_layer()).socket();
+  }
+
+  bool spliceable() const
+  {
+    return !parser_->is_done() && !parser_->chunked() &&
+           parser_->content_length().has_value() &&
+           fetchpp::detail::can_splice_to(parser_->get().body().fd);
+  }
+
+  // moves what the socket has to read, net::error::would_block asks to wait
+  // for it
+  error_code transfer()
+  {
+    error_code ec;
+    auto& body = parser_->get().body();
+    auto const moved = splicer_->transfer(
+        socket().native_handle(),
+        body.fd,
+        static_cast<std::size_t>(std::min<std::uint64_t>(
+            remaining_, fetchpp::detail::socket_splicer::chunk_size)),
+        ec);
+    body.delivered += moved;
+    remaining_ -= moved;
+    if (!ec && moved == 0)
+      ec = beast::http::error::partial_message;
+    return ec;
+  }
+
+  template <typename Self>
+  void complete(Self& self, error_code ec)
   {
-    parser_->body_limit(80 * 1024 * 1024);
-    if (req_.method() == beast::http::verb::connect ||
-        req_.method() == beast::http::verb::head)
-      parser_->skip(true);
+    transport_.cancel_timer();
+    deadline_.reset();
+    if (parser_)
+      res_ = parser_->release();
+    self.complete(ec);
   }
 
+  template <typename Self>
+  void operator()(Self& self, error_code ec = error_code{}, std::size_t = 0)
+  {
+    if (ec == net::error::operation_aborted && deadline_ &&
+        deadline_->expired())
+      ec = beast::error::timeout;
+    if (ec || !transport_.is_running())
+    {
+      complete(self, ec ? ec : error_code(net::error::operation_aborted));
+      return;
+    }
+    FETCHPP_REENTER(coro_)
+    {
+      transport_.setup_timer();
+      FETCHPP_YIELD detail::async_write_message(
+          transport_, req_, std::move(self));
+      parser_ = make_parser<parser_t>(transport_.memory_pool(), req_, res_);
+      FETCHPP_YIELD http::async_read_header(transport_.next_layer(),
+                                            transport_.buffer(),
+                                            *parser_,
+                                            std::move(self));
+      if (!spliceable())
+      {
+        FETCHPP_YIELD detail::run_async_read(transport_.next_layer(),
+                                             transport_.buffer(),
+                                             *parser_,
+                                             std::move(self));
+        complete(self, ec);
+        return;
+      }
+      transport_.buffer().consume(
+          parser_->put(transport_.buffer().data(), ec));
+      if (ec)
+      {
+        complete(self, ec);
+        return;
+      }
+      remaining_ = *parser_->content_length() - parser_->get().body().delivered;
+      splicer_ = fetchpp::detail::make_pooled<fetchpp::detail::socket_splicer>(
+          transport_.memory_pool());
+      deadline_ = fetchpp::detail::make_pooled<socket_deadline>(
+          transport_.memory_pool(),
+          socket(),
+          net::get_associated_executor(self, transport_.get_executor()),
+          transport_.operation_timeout());
+      while (remaining_ > 0)
+      {
+        ec = transfer();
+        if (ec == net::error::would_block)
+        {
+          FETCHPP_YIELD socket().async_wait(net::socket_base::wait_read,
+                                            std::move(self));
+        }
+        else if (ec)
+        {
+          complete(self, ec);
+          return;
+        }
+      }
+      complete(self, ec);
+    }
+  }
+};
+
+// a body streamed to an asynchronous sink is read a chunk at a time, the
+// next read waits for the sink to call back
+template <typename Response>
+constexpr bool streams_to_sink =
+    std::is_same_v<typename Response::body_type, http::streaming_body>;
+
+// the handler given to the sink may outlive the operation
+struct sink_signal
+{
+  explicit sink_signal(net::any_io_executor ex) : timer(std::move(ex))
+  {
+  }
+
+  net::steady_timer timer;
+  error_code ec;
+};
+
+template <typename AsyncTransport, typename Request, typename Response>
+struct sink_transport_op
+{
+  AsyncTransport& transport_;
+  Request& req_;
+  Response& res_;
+  using parser_t = response_parser_t<Response>;
+  fetchpp::detail::pooled_ptr<parser_t> parser_ = nullptr;
+  std::shared_ptr<sink_signal> signal_ = nullptr;
+  bool sinking_ = false;
+  net::coroutine coro_ = net::coroutine{};
+
+  sink_transport_op(AsyncTransport& transport, Request& req, Response& res)
+    : transport_(transport), req_(req), res_(res)
+  {
+  }
+
+  template <typename Self>
+  void complete(Self& self, error_code ec)
+  {
+    transport_.cancel_timer();
+    if (parser_)
+      res_ = parser_->release();
+    self.complete(ec);
+  }
+
+  template <typename Self>
+  void hand_pending(Self& self)
+  {
+    auto& body = parser_->get().body();
+    if (!signal_)
+      signal_ = std::allocate_shared<sink_signal>(
+          fetchpp::detail::recycling_allocator<sink_signal>(
+              transport_.memory_pool()),
+          net::get_associated_executor(self, transport_.get_executor()));
+    signal_->ec = {};
+    signal_->timer.expires_at(net::steady_timer::time_point::max());
+    body.async_sink(body.pending.data(), [signal = signal_](error_code ec) {
+      net::post(signal->timer.get_executor(), [signal, ec] {
+        signal->ec = ec;
+        signal->timer.cancel();
+      });
+    });
+  }
+
+  template <typename Self>
+  void operator()(Self& self, error_code ec = error_code{}, std::size_t = 0)
+  {
+    // the signal is cancelled once the sink is done
+    if (sinking_)
+    {
+      sinking_ = false;
+      ec = signal_->ec;
+    }
+    if (ec || !transport_.is_running())
+    {
+      complete(self, ec ? ec : error_code(net::error::operation_aborted));
+      return;
+    }
+    FETCHPP_REENTER(coro_)
+    {
+      transport_.setup_timer();
+      FETCHPP_YIELD detail::async_write_message(
+          transport_, req_, std::move(self));
+      parser_ = make_parser<parser_t>(transport_.memory_pool(), req_, res_);
+      if (!parser_->get().body().async_sink)
+      {
+        FETCHPP_YIELD detail::run_async_read(transport_.next_layer(),
+                                             transport_.buffer(),
+                                             *parser_,
+                                             std::move(self));
+        complete(self, ec);
+        return;
+      }
+      while (true)
+      {
+        FETCHPP_YIELD http::async_read_some(transport_.next_layer(),
+                                            transport_.buffer(),
+                                            *parser_,
+                                            std::move(self));
+        if (parser_->get().body().pending.size() > 0)
+        {
+          hand_pending(self);
+          sinking_ = true;
+          FETCHPP_YIELD signal_->timer.async_wait(std::move(self));
+          parser_->get().body().pending.clear();
+          // the time taken by the sink does not count against the transport
+          // timeout
+          transport_.setup_timer();
+        }
+        if (parser_->is_done())
+          break;
+      }
+      complete(self, ec);
+    }
+  }
+};
+
+template <typename AsyncTransport, typename Request>
+struct request_write_op
+{
+  AsyncTransport& transport_;
+  Request& req_;
+  net::coroutine coro_ = net::coroutine{};
+
   template <typename Self>
   void operator()(Self& self, error_code ec = error_code{}, std::size_t = 0)
   {
@@ -201,13 +894,50 @@ struct transport_op
     FETCHPP_REENTER(coro_)
     {
       transport_.setup_timer();
-      FETCHPP_YIELD detail::run_async_write(
-          transport_.next_layer(), req_, std::move(self));
+      FETCHPP_YIELD detail::async_write_message(
+          transport_, req_, std::move(self));
+      transport_.cancel_timer();
+      self.complete(ec);
+    }
+  }
+};
+
+template <typename AsyncTransport, typename Request, typename Response>
+struct response_read_op
+{
+  AsyncTransport& transport_;
+  Response& res_;
+  using parser_t = response_parser_t<Response>;
+  fetchpp::detail::pooled_ptr<parser_t> parser_;
+  net::coroutine coro_ = net::coroutine{};
+
+  response_read_op(AsyncTransport& transport, Request const& req, Response& res)
+    : transport_(transport),
+      res_(res),
+      parser_(make_parser<parser_t>(transport.memory_pool(), req, res))
+  {
+  }
+
+  template <typename Self>
+  void operator()(Self& self, error_code ec = error_code{}, std::size_t = 0)
+  {
+    if (ec || !transport_.is_running())
+    {
+      transport_.cancel_timer();
+      // the response, and what it carries, is handed back as it was read
+      if (parser_)
+        res_ = parser_->release();
+      self.complete(ec ? ec : error_code(net::error::operation_aborted));
+      return;
+    }
+    FETCHPP_REENTER(coro_)
+    {
+      transport_.setup_timer();
       FETCHPP_YIELD detail::run_async_read(transport_.next_layer(),
                                            transport_.buffer(),
                                            *parser_,
                                            std::move(self));
-      res_ = std::move(parser_->release());
+      res_ = parser_->release();
       transport_.cancel_timer();
       self.complete(ec);
     }
@@ -221,11 +951,12 @@ template <typename AsyncStream,
           typename Buffer,
           typename Request,
           typename Body,
+          typename Allocator,
           typename CompletionToken>
 auto async_process_one(AsyncStream& stream,
                        Buffer& buffer,
                        Request& request,
-                       beast::http::response_parser<Body>& parser,
+                       beast::http::response_parser<Body, Allocator>& parser,
                        CompletionToken&& token) ->
     typename net::async_result<std::decay_t<CompletionToken>,
                                void(error_code)>::return_type
@@ -272,11 +1003,62 @@ auto async_process_one(AsyncTransport& transport,
     typename net::async_result<typename std::decay_t<CompletionToken>,
                                void(error_code)>::return_type
 
+{
+  static_assert(is_async_transport<AsyncTransport>::value,
+                "AsyncTransport type requirements not met");
+  if constexpr (process_one::detail::splices_body<AsyncTransport, Response>)
+    return net::async_compose<CompletionToken, void(error_code)>(
+        process_one::detail::
+            splice_transport_op<AsyncTransport, Request, Response>{
+                transport, request, response},
+        token,
+        transport);
+  else if constexpr (process_one::detail::streams_to_sink<Response>)
+    return net::async_compose<CompletionToken, void(error_code)>(
+        process_one::detail::
+            sink_transport_op<AsyncTransport, Request, Response>{
+                transport, request, response},
+        token,
+        transport);
+  else
+    return net::async_compose<CompletionToken, void(error_code)>(
+        process_one::detail::transport_op<AsyncTransport, Request, Response>{
+            transport, request, response},
+        token,
+        transport);
+}
+
+template <typename AsyncTransport, typename Request, typename CompletionToken>
+auto async_write_request(AsyncTransport& transport,
+                         Request& request,
+                         CompletionToken&& token) ->
+    typename net::async_result<std::decay_t<CompletionToken>,
+                               void(error_code)>::return_type
+{
+  static_assert(is_async_transport<AsyncTransport>::value,
+                "AsyncTransport type requirements not met");
+  return net::async_compose<CompletionToken, void(error_code)>(
+      process_one::detail::request_write_op<AsyncTransport, Request>{transport,
+                                                                     request},
+      token,
+      transport);
+}
+
+template <typename AsyncTransport,
+          typename Request,
+          typename Response,
+          typename CompletionToken>
+auto async_read_response(AsyncTransport& transport,
+                         Request const& request,
+                         Response& response,
+                         CompletionToken&& token) ->
+    typename net::async_result<std::decay_t<CompletionToken>,
+                               void(error_code)>::return_type
 {
   static_assert(is_async_transport<AsyncTransport>::value,
                 "AsyncTransport type requirements not met");
   return net::async_compose<CompletionToken, void(error_code)>(
-      process_one::detail::transport_op<AsyncTransport, Request, Response>{
+      process_one::detail::response_read_op<AsyncTransport, Request, Response>{
           transport, request, response},
       token,
       transport);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/verb.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+namespace fetchpp
+{
+// what went wrong with an attempt, as far as retrying is concerned
+enum class failure_kind
+{
+  // the connection could not be established, the request was not sent
+  connect,
+  // a reused connection was closed before the response, the server most
+  // likely dropped it while it was idle
+  stale_connection,
+  // a new connection was closed before the response was complete
+  connection_lost,
+  timeout,
+  other,
+};
+
+failure_kind classify_failure(error_code ec,
+                              bool connecting,
+                              bool reused_connection);
+bool is_idempotent(http::verb method);
+
+struct retry_policy
+{
+  // attempts of a request, the first one included, 1 disables retries
+  std::size_t max_attempts = 2;
+  // the nth retry waits a random delay up to
+  // min(max_backoff, base_backoff * 2^(n-1)), stale connections are retried
+  // right away
+  std::chrono::nanoseconds base_backoff = std::chrono::milliseconds(50);
+  std::chrono::nanoseconds max_backoff = std::chrono::seconds(2);
+
+  bool retry_connect = false;
+  bool retry_stale_connection = true;
+  bool retry_connection_lost = true;
+  bool retry_timeout = false;
+  // replaces the flags above when set
+  std::function<bool(failure_kind, error_code)> retry_if;
+  // otherwise only connect failures are retried, the server may have
+  // processed the request in every other case
+  bool retry_non_idempotent = false;
+
+  // retries may not exceed budget_ratio of the requests, bursts can use up
+  // to budget_reserve retries
+  double budget_ratio = 0.2;
+  std::size_t budget_reserve = 10;
+
+  bool retries(failure_kind kind, error_code ec) const;
+};
+
+// a token bucket shared by the sessions of a client: each request deposits
+// a fraction of a retry and each retry withdraws a whole one
+class retry_budget
+{
+public:
+  retry_budget(double ratio, std::size_t reserve);
+
+  void deposit();
+  bool withdraw();
+  double balance() const;
+
+private:
+  mutable std::mutex mutex_;
+  double ratio_;
+  double capacity_;
+  double balance_;
+};
+}
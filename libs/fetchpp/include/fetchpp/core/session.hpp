@@ -3,15 +3,23 @@
 #include <fetchpp/core/basic_transport.hpp>
 #include <fetchpp/core/detail/coroutine.hpp>
 #include <fetchpp/core/process_one.hpp>
+#include <fetchpp/core/retry_policy.hpp>
 #include <fetchpp/core/ssl_transport.hpp>
 #include <fetchpp/core/tcp_transport.hpp>
 #include <fetchpp/core/tunnel_transport.hpp>
+#include <fetchpp/http/fd_body.hpp>
+#include <fetchpp/http/json_body.hpp>
+#include <fetchpp/http/streaming_body.hpp>
 
+#include <fetchpp/core/detail/recycling_pool.hpp>
 #include <fetchpp/core/detail/session_base.hpp>
 
 #include <fetchpp/net/make_dispatch.hpp>
 #include <fetchpp/net/make_post.hpp>
 
+#include <boost/asio/associated_cancellation_slot.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/cancellation_type.hpp>
 #include <boost/asio/compose.hpp>
 #include <boost/asio/dispatch.hpp>
 #include <boost/asio/ip/tcp.hpp>
@@ -21,22 +29,113 @@
 
 #include <fetchpp/alias/beast.hpp>
 #include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
 #include <fetchpp/alias/net.hpp>
 #include <fetchpp/alias/tcp.hpp>
 
 #include <chrono>
+#include <optional>
+#include <type_traits>
+#include <utility>
 
 namespace fetchpp
 {
 namespace detail
 {
+template <typename Request, typename = void>
+struct has_timeout : std::false_type
+{
+};
+
+template <typename Request>
+struct has_timeout<
+    Request,
+    std::void_t<decltype(std::declval<Request const&>().timeout())>>
+  : std::true_type
+{
+};
+
+template <typename Request>
+std::optional<session_base::clock_type::time_point> request_deadline(
+    Request const& request)
+{
+  if constexpr (has_timeout<Request>::value)
+  {
+    if (auto const timeout = request.timeout())
+      return session_base::clock_type::now() +
+             std::chrono::duration_cast<session_base::clock_type::duration>(
+                 *timeout);
+  }
+  return std::nullopt;
+}
+
+template <typename Request, typename = void>
+struct has_priority : std::false_type
+{
+};
+
+template <typename Request>
+struct has_priority<
+    Request,
+    std::void_t<decltype(std::declval<Request const&>().priority())>>
+  : std::true_type
+{
+};
+
+template <typename Request>
+int request_priority(Request const& request)
+{
+  if constexpr (has_priority<Request>::value)
+    return request.priority();
+  else
+    return 0;
+}
+
+// what a sink, a file or a sax handler received cannot be taken back: a
+// streamed response is not pipelined, and not attempted again once its body
+// started
+template <typename Response>
+constexpr bool streams_body =
+    std::is_same_v<typename Response::body_type, http::streaming_body> ||
+    std::is_same_v<typename Response::body_type, http::fd_body> ||
+    std::is_same_v<typename Response::body_type, http::json_body>;
+
+template <typename Response>
+bool body_delivered(Response const& response)
+{
+  if constexpr (streams_body<Response>)
+    return response.body().delivered > 0;
+  else
+    return false;
+}
+
+// how long to wait before the next attempt of a task which failed with ec,
+// nullopt when it fails for good
+template <typename TaskState>
+std::optional<std::chrono::nanoseconds> next_retry_delay(TaskState& task,
+                                                         failure_kind kind,
+                                                         error_code ec)
+{
+  if (body_delivered(task.response_))
+    return std::nullopt;
+  auto const delay = task.session_.retry_delay(
+      kind, ec, task.attempt_, is_idempotent(task.request_.method()));
+  if (!delay || (task.deadline_ &&
+                 session_base::clock_type::now() + *delay >= *task.deadline_))
+    return std::nullopt;
+  ++task.attempt_;
+  return delay;
+}
+
 template <typename TaskState>
 struct process_queue_op
 {
   TaskState& task_;
   error_code last_ec_ = {};
   net::coroutine coro_ = {};
-  bool first_round_ = true;
+  bool reused_ = false;
+  bool connecting_ = false;
+  std::optional<std::chrono::nanoseconds> retry_delay_ = std::nullopt;
 
   using executor_type =
       typename TaskState::session_type::internal_executor_type;
@@ -45,9 +144,17 @@ struct process_queue_op
     return task_.session_.get_internal_executor();
   }
 
+  using allocator_type = recycling_allocator<void>;
+  allocator_type get_allocator() const
+  {
+    return allocator_type(task_.session_.memory_pool());
+  }
+
   template <typename... Args>
   void complete(Args&&... args)
   {
+    transport().set_deadline(std::nullopt);
+    task_.clear_cancellation_slot();
     auto h_ex = net::get_associated_executor(
         task_.handler_, task_.session_.get_default_executor());
     net::post(h_ex,
@@ -68,6 +175,12 @@ struct process_queue_op
     return task_.session_;
   }
 
+  bool expired() const
+  {
+    return task_.deadline_ &&
+           session_base::clock_type::now() >= *task_.deadline_;
+  }
+
   decltype(auto) transport()
 
   {
@@ -82,50 +195,64 @@ struct process_queue_op
   void operator()(error_code ec = {})
   {
     BOOST_ASSERT(get_executor().running_in_this_thread());
-    if (!still_running() || ec == net::error::operation_aborted)
+    if (!still_running() || ec == net::error::operation_aborted ||
+        task_.cancelled_)
     {
+      // a connection established after the cancellation is unusable
+      if (task_.cancelled_ && connecting_)
+        transport().abort();
       complete(net::error::operation_aborted);
       return;
     }
 
     FETCHPP_REENTER(coro_)
     {
-      if (!transport().is_open() && still_running())
+      transport().set_deadline(task_.deadline_);
+      reused_ = transport().is_open();
+      connecting_ = !reused_;
+      if (connecting_)
       {
         FETCHPP_YIELD task_.session_.async_transport_connect(std::move(*this));
-        if (ec)
-        {
-          session().set_running(false);
-          complete(ec);
-          return;
-        }
+      }
+      if (!ec)
+      {
+        connecting_ = false;
+        FETCHPP_YIELD async_process_one(session().transport_,
+                                        task_.request_,
+                                        task_.response_,
+                                        std::move(*this));
       }
 
-      FETCHPP_YIELD async_process_one(session().transport_,
-                                      task_.request_,
-                                      task_.response_,
-                                      std::move(*this));
-
-      // If an error occurred and this is a reused connection, silence the
-      // error and try again
       if (ec)
       {
         last_ec_ = ec;
-        FETCHPP_YIELD
-        session().transport_.async_close(std::move(*this));
+        // the transport is recreated on the next connection, there is
+        // nothing to shut down gracefully on a half established one
+        FETCHPP_YIELD session().transport_.async_close(
+            connecting_ ? GracefulShutdown::No : GracefulShutdown::Yes,
+            std::move(*this));
         ec = last_ec_;
-        if (first_round_)
+        // the request ran out of time, the session itself is fine
+        if (expired())
+        {
+          complete(beast::error::timeout);
+          return;
+        }
+        retry_delay_ = next_retry_delay(
+            task_, classify_failure(ec, connecting_, reused_), ec);
+        if (retry_delay_.has_value())
         {
+          if (retry_delay_->count() > 0)
+          {
+            FETCHPP_YIELD session().async_wait_for_retry(*retry_delay_,
+                                                         std::move(*this));
+          }
           // we reset the coroutine state to try a re-connection
           coro_ = {};
-          first_round_ = false;
           net::post(beast::bind_front_handler(std::move(*this), error_code{}));
           return;
         }
-        else
-        {
-          session().set_running(false);
-        }
+        session().set_failed();
       }
 
       complete(ec);
@@ -146,6 +273,19 @@ struct task_state
   Request& request_;
   Response& response_;
   Handler handler_;
+  std::optional<session_base::clock_type::time_point> deadline_ = std::nullopt;
+  net::associated_cancellation_slot_t<Handler> slot_ =
+      net::get_associated_cancellation_slot(handler_);
+  bool cancelled_ = false;
+  // the attempt being made, pipelined ones included
+  std::size_t attempt_ = 1;
+
+  // called before the handler is invoked, it no longer accepts cancellation
+  void clear_cancellation_slot()
+  {
+    if (slot_.is_connected())
+      slot_.clear();
+  }
 };
 template <typename Session,
           typename Request,
@@ -153,6 +293,131 @@ template <typename Session,
           typename Handler>
 task_state(Session&, Request&, Response&, Handler)
     -> task_state<Session, Request, Response, Handler>;
+template <typename Session,
+          typename Request,
+          typename Response,
+          typename Handler>
+task_state(Session&,
+           Request&,
+           Response&,
+           Handler,
+           std::optional<session_base::clock_type::time_point>)
+    -> task_state<Session, Request, Response, Handler>;
+
+template <typename Session>
+struct pipeline_op
+{
+  Session& session_;
+  std::size_t batch_ = 0;
+  std::size_t index_ = 0;
+  // the tasks of the batch started and still queued
+  std::size_t started_ = 0;
+  error_code last_ec_ = {};
+  std::optional<std::chrono::nanoseconds> retry_delay_ = std::nullopt;
+  net::coroutine coro_ = {};
+
+  using executor_type = typename Session::internal_executor_type;
+  auto get_executor() const
+  {
+    return session_.get_internal_executor();
+  }
+
+  using allocator_type = recycling_allocator<void>;
+  allocator_type get_allocator() const
+  {
+    return allocator_type(session_.memory_pool());
+  }
+
+  // the connection was dropped by a cancelled task or by the session
+  // stopping, rather than by the exchange
+  bool interrupted()
+  {
+    if (!session_.running())
+      return true;
+    for (std::size_t i = 0; i < started_; ++i)
+      if (session_.task_at(i).cancelled())
+        return true;
+    return false;
+  }
+
+  void operator()(error_code ec = {})
+  {
+    BOOST_ASSERT(get_executor().running_in_this_thread());
+    FETCHPP_REENTER(coro_)
+    {
+      batch_ = session_.pipeline_batch();
+      for (index_ = 0; index_ < batch_; ++index_)
+      {
+        session_.task_at(index_).started = true;
+        ++started_;
+        FETCHPP_YIELD session_.task_at(index_).async_write(
+            detail::pooled_handler(session_.memory_pool(), std::move(*this)));
+        if (ec)
+          break;
+      }
+      if (!ec)
+      {
+        // responses come back in the order the requests were written
+        for (index_ = 0; index_ < batch_; ++index_)
+        {
+          FETCHPP_YIELD session_.front_task().async_read(
+              detail::pooled_handler(session_.memory_pool(), std::move(*this)));
+          if (ec || index_ + 1 == batch_ ||
+              !session_.front_task().keep_alive())
+            break;
+          session_.front_task().complete(ec);
+          --started_;
+          // the next task of the batch has started, it is not run again
+          session_.advance_task();
+          if (!session_.running())
+            return;
+        }
+      }
+      if (ec)
+      {
+        last_ec_ = ec;
+        // the server may not support pipelining, the unanswered requests
+        // are processed one at a time on a new connection
+        session_.disable_pipelining();
+        FETCHPP_YIELD session_.transport().async_close(std::move(*this));
+        // the tasks report the interruption themselves once run again
+        if (interrupted())
+        {
+          session_.restart_tasks(started_);
+          session_.process_task();
+          return;
+        }
+        // the exchange of the front task failed: it is retried within the
+        // retry policy and budget, like a task processed alone. The others
+        // were left unanswered and are sent again
+        retry_delay_ = session_.front_task().next_retry_delay(last_ec_);
+        session_.restart_tasks(started_);
+        if (!retry_delay_)
+        {
+          session_.front_task().complete(last_ec_);
+          session_.advance_task();
+          return;
+        }
+        if (retry_delay_->count() > 0)
+        {
+          FETCHPP_YIELD session_.async_wait_for_retry(*retry_delay_,
+                                                      std::move(*this));
+        }
+        session_.process_task();
+        return;
+      }
+      // the requests written after this one will not be answered, they are
+      // sent again on a new connection
+      if (!session_.front_task().keep_alive())
+      {
+        FETCHPP_YIELD session_.transport().async_close(std::move(*this));
+      }
+      session_.restart_tasks(started_);
+      session_.front_task().complete({});
+      session_.advance_task();
+    }
+  }
+};
 
 template <typename TaskState>
 auto make_task(TaskState&& state)
@@ -165,26 +430,115 @@ auto make_task(TaskState&& state)
     {
     }
 
+    void destroy() noexcept override
+    {
+      auto* pool = state_.session_.memory_pool().get();
+      this->~session_task();
+      pool->deallocate(this, sizeof(session_task), alignof(session_task));
+    }
+
     void run() override
     {
       BOOST_ASSERT(
           state_.session_.get_internal_executor().running_in_this_thread());
 
+      // a connection must be established before pipelining requests on it
+      if (!state_.cancelled_ && state_.session_.transport().is_open() &&
+          state_.session_.pipeline_batch() > 1)
+      {
+        pipeline_op<typename TaskState::session_type>{state_.session_}();
+        return;
+      }
       process_queue_op op{state_};
       op();
     }
 
+    bool pipelinable() const override
+    {
+      using response_type = std::decay_t<decltype(state_.response_)>;
+      if constexpr (streams_body<response_type>)
+        return false;
+      // a deadline is enforced on the transport, which a batch shares: only
+      // a request processed alone can expire without failing the others
+      if (state_.deadline_)
+        return false;
+      auto const method = state_.request_.method();
+      return (method == http::verb::get || method == http::verb::head) &&
+             state_.request_.keep_alive() && !state_.cancelled_;
+    }
+
+    void async_write(handler_t handler) override
+    {
+      fetchpp::async_write_request(
+          state_.session_.transport(),
+          state_.request_,
+          net::bind_executor(state_.session_.get_internal_executor(),
+                             std::move(handler)));
+    }
+
+    void async_read(handler_t handler) override
+    {
+      fetchpp::async_read_response(
+          state_.session_.transport(),
+          state_.request_,
+          state_.response_,
+          net::bind_executor(state_.session_.get_internal_executor(),
+                             std::move(handler)));
+    }
+
+    bool keep_alive() const override
+    {
+      return state_.response_.keep_alive();
+    }
+
+    bool cancelled() const override
+    {
+      return state_.cancelled_;
+    }
+
+    std::optional<std::chrono::nanoseconds> next_retry_delay(
+        error_code ec) override
+    {
+      // a pipelined request is written on an established connection
+      return detail::next_retry_delay(
+          state_, classify_failure(ec, false, true), ec);
+    }
+
+    void complete(error_code ec) override
+    {
+      state_.clear_cancellation_slot();
+      auto h_ex = net::get_associated_executor(
+          state_.handler_, state_.session_.get_default_executor());
+      net::post(h_ex,
+                beast::bind_front_handler(std::move(state_.handler_), ec));
+    }
+
     void cancel() override
     {
       BOOST_ASSERT(
           state_.session_.get_internal_executor().running_in_this_thread());
+      state_.clear_cancellation_slot();
       net::make_post(
           beast::bind_front_handler(std::move(state_.handler_),
                                     boost::asio::error::operation_aborted),
           state_.session_.get_default_executor());
     }
+
+    void abort() override
+    {
+      // the connection is dropped, whatever the task is waiting for
+      // completes with an error and the task reports the cancellation.
+      // pipelined tasks are sent again up to the cancelled one
+      state_.cancelled_ = true;
+      state_.session_.cancel_retry();
+      state_.session_.transport().abort();
+    }
   };
-  return std::make_unique<session_task>(std::move(state));
+  // the task memory comes from the session pool, it is given back by
+  // destroy()
+  auto* memory = state.session_.memory_pool()->allocate(
+      sizeof(session_task), alignof(session_task));
+  return detail::task::ptr_t(new (memory) session_task(std::move(state)));
 }
 
 template <typename Session,
@@ -206,16 +560,30 @@ struct push_op
 
   void operator()()
   {
+    session_.release();
+    auto slot = net::get_associated_cancellation_slot(handler_);
     if (!session_.running())
     {
+      if (slot.is_connected())
+        slot.clear();
       net::make_post(beast::bind_front_handler(std::move(handler_),
                                                net::error::operation_aborted),
                      session_.get_default_executor());
       return;
     }
     BOOST_ASSERT(session_.get_internal_executor().running_in_this_thread());
-    session_.push_task(detail::make_task(detail::task_state{
-        session_, request_, response_, std::move(handler_)}));
+    auto const deadline = request_deadline(request_);
+    auto task = detail::make_task(detail::task_state{
+        session_, request_, response_, std::move(handler_), deadline});
+    task->priority = request_priority(request_);
+    auto const id = session_.push_task(std::move(task), deadline);
+    if (slot.is_connected())
+    {
+      slot.assign([&sess = session_, id](net::cancellation_type) {
+        net::post(sess.get_internal_executor(),
+                  [&sess, id] { sess.cancel_task(id); });
+      });
+    }
     if (session_.pending_tasks() == 1)
       net::post(session_.get_internal_executor(),
                 [&sess = session_]() { sess.process_task(); });
@@ -260,17 +628,13 @@ start_op(Session& session, Handler) -> start_op<Session, Handler>;
 template <typename Session, typename Handler>
 struct stop_op
 {
-  struct state
-  {
-    GracefulShutdown gr_;
-    Session& session_;
-    Handler handler_;
-  };
-  std::unique_ptr<state> state_;
+  GracefulShutdown gr_;
+  Session& session_;
+  Handler handler_;
   net::coroutine coro_ = {};
 
   stop_op(GracefulShutdown gr, Session& sess, Handler&& h)
-    : state_(std::unique_ptr<state>(new state{gr, sess, std::move(h)}))
+    : gr_(gr), session_(sess), handler_(std::move(h))
   {
   }
 
@@ -278,14 +642,13 @@ struct stop_op
   {
     FETCHPP_REENTER(coro_)
     {
-      BOOST_ASSERT(
-          state_->session_.get_internal_executor().running_in_this_thread());
-      state_->session_.set_running(false);
-      FETCHPP_YIELD state_->session_.async_transport_close(state_->gr_,
-                                                           std::move(*this));
-      if (state_->session_.has_tasks())
+      BOOST_ASSERT(session_.get_internal_executor().running_in_this_thread());
+      session_.set_running(false);
+      session_.cancel_retry();
+      FETCHPP_YIELD session_.async_transport_close(gr_, std::move(*this));
+      if (session_.has_tasks())
       {
-        FETCHPP_YIELD state_->session_.async_wait_for_tasks_cancellation(
+        FETCHPP_YIELD session_.async_wait_for_tasks_cancellation(
             std::move(*this));
         // we cancel the timer when all tasks have been cancelled
         if (ec == net::error::operation_aborted)
@@ -294,16 +657,15 @@ struct stop_op
         else if (!ec)
           ec = net::error::timed_out;
       }
-      net::make_dispatch(
-          beast::bind_front_handler(std::move(state_->handler_), ec),
-          state_->session_.get_default_executor());
+      net::make_dispatch(beast::bind_front_handler(std::move(handler_), ec),
+                         session_.get_default_executor());
     }
   }
 
   using executor_type = typename Session::internal_executor_type;
   auto get_executor() const
   {
-    return state_->session_.get_internal_executor();
+    return session_.get_internal_executor();
   }
 };
 }
@@ -337,6 +699,7 @@ public:
       endpoint_(std::move(endpoint)),
       transport_(ex, std::forward<Args>(args)...)
   {
+    transport_.set_memory_pool(this->memory_pool());
   }
 
   template <typename CompletionToken>
@@ -388,6 +751,19 @@ public:
     return endpoint_;
   }
 
+  transport_type& transport()
+  {
+    return transport_;
+  }
+
+  // restarts a failed session, the transport is recreated on next connect
+  void revive()
+  {
+    BOOST_ASSERT(this->failed());
+    transport_.set_running(false);
+    this->set_running(true);
+  }
+
 private:
   template <typename CompletionToken>
   auto async_transport_connect(CompletionToken&& token)
@@ -403,11 +779,6 @@ private:
                                          std::forward<CompletionToken>(token));
   }
 
-  transport_type& transport()
-  {
-    return transport_;
-  }
-
   endpoint_type endpoint_;
   transport_type transport_;
 };
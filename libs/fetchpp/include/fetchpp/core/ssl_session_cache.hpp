@@ -0,0 +1,59 @@
+#pragma once
+
+#include <boost/asio/ssl/context.hpp>
+
+#include <fetchpp/alias/net.hpp>
+
+#include <openssl/ssl.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace fetchpp
+{
+// TLS sessions of a client, per endpoint, so that reconnections resume
+// them instead of doing a full handshake.
+// endpoints are told apart by context and verify mode as well, a session
+// never outlives the verification it was negotiated under.
+// sessions are received from the SSL_CTX the cache is attached to, which
+// also covers TLS 1.3 tickets sent after the handshake.
+class ssl_session_cache : public std::enable_shared_from_this<ssl_session_cache>
+{
+public:
+  explicit ssl_session_cache(std::size_t capacity = 256);
+  ~ssl_session_cache();
+
+  ssl_session_cache(ssl_session_cache const&) = delete;
+  ssl_session_cache& operator=(ssl_session_cache const&) = delete;
+
+  // makes the context hand its new client sessions over to the cache, and
+  // gives it the identity its sessions are filed under
+  static void attach(net::ssl::context& context);
+
+  // offers the cached session of this endpoint to ssl, the sessions ssl
+  // receives replace it
+  void prepare(SSL* ssl, std::string const& host, std::uint16_t port);
+  // records whether the handshake resumed the offered session
+  void handshake_done(SSL* ssl);
+  void clear();
+
+  std::size_t size() const;
+  std::size_t handshakes() const;
+  std::size_t resumptions() const;
+
+private:
+  static int on_new_session(SSL* ssl, SSL_SESSION* session);
+  void store(std::string const& key, SSL_SESSION* session);
+
+  std::size_t capacity_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, SSL_SESSION*> sessions_;
+  std::atomic<std::size_t> handshakes_{0};
+  std::atomic<std::size_t> resumptions_{0};
+};
+}
@@ -3,10 +3,14 @@
 #include <fetchpp/core/basic_transport.hpp>
 #include <fetchpp/core/detail/close_ssl.hpp>
 #include <fetchpp/core/detail/coroutine.hpp>
+#include <fetchpp/core/detail/happy_eyeballs.hpp>
+#include <fetchpp/core/ssl_session_cache.hpp>
 
 #include <boost/asio/compose.hpp>
 #include <boost/beast/core/bind_handler.hpp>
 #include <boost/beast/core/error.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/flat_static_buffer.hpp>
 #include <boost/beast/core/multi_buffer.hpp>
 #include <boost/beast/core/tcp_stream.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
@@ -48,8 +52,13 @@ struct async_ssl_connect_op
         return self.complete(error_code{static_cast<int>(::ERR_get_error()),
                                         net::error::get_ssl_category()});
 
-      FETCHPP_YIELD beast::get_lowest_layer(transport_.next_layer())
-          .async_connect(*results_, std::move(self));
+      FETCHPP_YIELD async_happy_eyeballs_connect(
+          beast::get_lowest_layer(transport_.next_layer()),
+          *results_,
+          transport_.connection_attempt_delay(),
+          transport_.operation_timeout(),
+          transport_.connection_race(),
+          std::move(self));
       beast::get_lowest_layer(transport_)
           .socket()
           .set_option(net::ip::tcp::no_delay{true}, ec);
@@ -58,8 +67,14 @@ struct async_ssl_connect_op
         self.complete(ec);
         return;
       }
+      if (auto const& cache = transport_.get_ssl_session_cache())
+        cache->prepare(transport_.next_layer().native_handle(),
+                       domain_,
+                       results_->begin()->endpoint().port());
       FETCHPP_YIELD transport_.next_layer().async_handshake(
           net::ssl::stream_base::client, std::move(self));
+      if (auto const& cache = transport_.get_ssl_session_cache())
+        cache->handshake_done(transport_.next_layer().native_handle());
       self.complete(ec);
     }
   }
@@ -100,5 +115,12 @@ auto do_async_close(
 using ssl_async_transport =
     basic_async_transport<beast::ssl_stream<beast::tcp_stream>,
                           beast::multi_buffer>;
+using ssl_flat_async_transport =
+    basic_async_transport<beast::ssl_stream<beast::tcp_stream>,
+                          beast::flat_buffer>;
+template <std::size_t N>
+using ssl_flat_static_async_transport =
+    basic_async_transport<beast::ssl_stream<beast::tcp_stream>,
+                          beast::flat_static_buffer<N>>;
 
 }
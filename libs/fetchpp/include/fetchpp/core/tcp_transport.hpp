@@ -1,10 +1,13 @@
 #pragma once
 
 #include <fetchpp/core/basic_transport.hpp>
+#include <fetchpp/core/detail/happy_eyeballs.hpp>
 #include <fetchpp/core/endpoint.hpp>
 
 #include <boost/asio/compose.hpp>
 #include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/flat_static_buffer.hpp>
 #include <boost/beast/core/multi_buffer.hpp>
 #include <boost/beast/core/stream_traits.hpp>
 #include <boost/beast/core/tcp_stream.hpp>
@@ -36,8 +39,13 @@ struct async_tcp_connect_op
     }
     FETCHPP_REENTER(coro_)
     {
-      FETCHPP_YIELD beast::get_lowest_layer(transport_)
-          .async_connect(*results_, std::move(self));
+      FETCHPP_YIELD async_happy_eyeballs_connect(
+          beast::get_lowest_layer(transport_),
+          *results_,
+          transport_.connection_attempt_delay(),
+          transport_.operation_timeout(),
+          transport_.connection_race(),
+          std::move(self));
       beast::get_lowest_layer(transport_)
           .socket()
           .set_option(net::ip::tcp::no_delay{true});
@@ -107,4 +115,11 @@ auto do_async_close(basic_async_transport<
 
 using tcp_async_transport =
     basic_async_transport<beast::tcp_stream, beast::multi_buffer>;
+// the responses are parsed from one contiguous buffer, which the parser does
+// not have to linearize
+using tcp_flat_async_transport =
+    basic_async_transport<beast::tcp_stream, beast::flat_buffer>;
+template <std::size_t N>
+using tcp_flat_static_async_transport =
+    basic_async_transport<beast::tcp_stream, beast::flat_static_buffer<N>>;
 }
@@ -2,7 +2,9 @@
 
 #include <fetchpp/core/basic_transport.hpp>
 #include <fetchpp/core/detail/close_ssl.hpp>
+#include <fetchpp/core/detail/happy_eyeballs.hpp>
 #include <fetchpp/core/endpoint.hpp>
+#include <fetchpp/core/ssl_session_cache.hpp>
 #include <fetchpp/core/process_one.hpp>
 #include <fetchpp/http/request.hpp>
 #include <fetchpp/http/response.hpp>
@@ -11,6 +13,8 @@
 #include <boost/asio/executor.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl/context.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/flat_static_buffer.hpp>
 #include <boost/beast/core/multi_buffer.hpp>
 #include <boost/beast/core/tcp_stream.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
@@ -21,9 +25,14 @@
 #include <fetchpp/alias/ssl.hpp>
 #include <fetchpp/alias/tcp.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
 namespace fetchpp
 {
-class tunnel_async_transport;
+template <typename DynamicBuffer>
+class basic_tunnel_async_transport;
 
 namespace detail
 {
@@ -58,13 +67,15 @@ struct async_tunnel_connect_op
     }
     FETCHPP_REENTER(coro_)
     {
+      if (!transport_.is_running())
+        transport_.reset();
       transport_.set_running(true);
       transport_.setup_timer();
-      FETCHPP_YIELD transport_.resolver_.async_resolve(
-          endpoint_.proxy().domain(),
-          std::to_string(endpoint_.proxy().port()),
-          net::ip::resolver_base::numeric_service,
-          std::move(self));
+      FETCHPP_YIELD async_resolve(transport_.resolver_,
+                                  transport_.get_dns_cache().get(),
+                                  endpoint_.proxy().domain(),
+                                  endpoint_.proxy().port(),
+                                  std::move(self));
       beast::get_lowest_layer(transport_)
           .socket()
           .set_option(net::ip::tcp::no_delay{true});
@@ -86,8 +97,14 @@ struct async_tunnel_connect_op
         transport_.cancel_timer();
         return;
       }
+      if (auto const& cache = transport_.get_ssl_session_cache())
+        cache->prepare(transport_.next_layer().native_handle(),
+                       endpoint_.target().domain(),
+                       endpoint_.target().port());
       FETCHPP_YIELD transport_.next_layer().async_handshake(
           net::ssl::stream_base::client, std::move(self));
+      if (auto const& cache = transport_.get_ssl_session_cache())
+        cache->handshake_done(transport_.next_layer().native_handle());
       transport_.cancel_timer();
       self.complete(ec);
     }
@@ -109,7 +126,12 @@ struct async_tunnel_connect_op
                                   endpoint_.target().domain().data()))
       return self.complete(error_code{static_cast<int>(::ERR_get_error()),
                                       net::error::get_ssl_category()});
-    beast::get_lowest_layer(transport_).async_connect(results, std::move(self));
+    async_happy_eyeballs_connect(beast::get_lowest_layer(transport_),
+                                 results,
+                                 transport_.connection_attempt_delay(),
+                                 transport_.operation_timeout(),
+                                 transport_.connection_race(),
+                                 std::move(self));
   }
 };
 
@@ -117,29 +139,34 @@ template <typename Transport>
 async_tunnel_connect_op(tunnel_endpoint, Transport&)
     -> async_tunnel_connect_op<Transport>;
 
-template <typename CompletionToken>
-auto do_async_close(tunnel_async_transport& ts, CompletionToken&& token);
+template <typename DynamicBuffer, typename CompletionToken>
+auto do_async_close(basic_tunnel_async_transport<DynamicBuffer>& ts,
+                    CompletionToken&& token);
 }
 
-class tunnel_async_transport
+template <typename DynamicBuffer>
+class basic_tunnel_async_transport : public detail::transport_base
 {
+  static_assert(net::is_dynamic_buffer<DynamicBuffer>::value,
+                "DynamicBuffer type requirements not met");
+
   template <typename AsyncTransport>
   friend struct detail::async_tunnel_connect_op;
 
 public:
-  using buffer_type = beast::multi_buffer;
+  using buffer_type = DynamicBuffer;
   using next_layer_type = beast::ssl_stream<beast::tcp_stream>;
   using executor_type = typename next_layer_type::executor_type;
   using next_layer_creator_sig = next_layer_type();
   using next_layer_creator = std::function<next_layer_creator_sig>;
 
-  tunnel_async_transport(net::any_io_executor ex,
-                         std::chrono::nanoseconds timeout,
-                         net::ssl::context& ctx)
-    : stream_creator_([ex, &ctx]() { return next_layer_type(ex, ctx); }),
+  basic_tunnel_async_transport(net::any_io_executor ex,
+                               std::chrono::nanoseconds timeout,
+                               net::ssl::context& ctx)
+    : detail::transport_base(timeout),
+      stream_creator_([ex, &ctx]() { return next_layer_type(ex, ctx); }),
       stream_(std::make_unique<next_layer_type>(stream_creator_())),
-      resolver_(next_layer().get_executor()),
-      timeout_(timeout)
+      resolver_(next_layer().get_executor())
   {
   }
 
@@ -194,6 +221,7 @@ public:
             else
             {
               this->resolver().cancel();
+              this->cancel_connection_race();
               FETCHPP_YIELD net::post(
                   beast::bind_front_handler(std::move(self)));
             }
@@ -229,7 +257,7 @@ public:
 
   void setup_timer()
   {
-    get_lowest_layer(next_layer()).expires_after(timeout_);
+    get_lowest_layer(next_layer()).expires_after(operation_timeout());
   }
 
   void cancel_timer()
@@ -247,9 +275,15 @@ public:
     return beast::get_lowest_layer(next_layer()).socket().is_open();
   }
 
-  auto const& timeout() const
+  // drops the connection at once, the pending operations complete with
+  // net::error::operation_aborted
+  void abort()
   {
-    return timeout_;
+    set_running(false);
+    this->resolver().cancel();
+    this->cancel_connection_race();
+    error_code ignored;
+    beast::get_lowest_layer(next_layer()).socket().close(ignored);
   }
 
   auto get_executor()
@@ -267,32 +301,29 @@ public:
     return buffer_;
   }
 
-  void set_running(bool r = true)
-  {
-    running_ = r;
-  }
-
-  bool is_running() const
-  {
-    return running_;
-  }
-
 private:
   next_layer_creator stream_creator_;
   buffer_type buffer_;
   std::unique_ptr<next_layer_type> stream_;
   tcp::resolver resolver_;
-  std::chrono::nanoseconds timeout_;
-  bool running_ = true;
 };
 
 namespace detail
 {
-template <typename CompletionToken>
-auto do_async_close(tunnel_async_transport& ts, CompletionToken&& token)
+template <typename DynamicBuffer, typename CompletionToken>
+auto do_async_close(basic_tunnel_async_transport<DynamicBuffer>& ts,
+                    CompletionToken&& token)
 {
   return net::async_compose<CompletionToken, void(error_code)>(
       detail::async_ssl_close_op{ts.next_layer()}, token, ts);
 }
 }
+
+using tunnel_async_transport =
+    basic_tunnel_async_transport<beast::multi_buffer>;
+using tunnel_flat_async_transport =
+    basic_tunnel_async_transport<beast::flat_buffer>;
+template <std::size_t N>
+using tunnel_flat_static_async_transport =
+    basic_tunnel_async_transport<beast::flat_static_buffer<N>>;
 }
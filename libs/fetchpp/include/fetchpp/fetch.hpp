@@ -1,5 +1,7 @@
 #pragma once
 
+#include <fetchpp/pooled_client.hpp>
+
 #include <fetchpp/http/request.hpp>
 #include <fetchpp/http/response.hpp>
 
@@ -12,6 +14,7 @@
 #include <fetchpp/alias/ssl.hpp>
 
 #include <functional>
+#include <type_traits>
 
 namespace fetchpp
 {
@@ -31,7 +34,7 @@ auto async_fetch(net::any_io_executor ex,
                    Request request) {
     auto s = detail::make_state<detail::base_state, Response>(
         std::move(endpoint),
-        ssl_async_transport(ex, std::chrono::seconds(30), sslc),
+        ssl_flat_async_transport(ex, std::chrono::seconds(30), sslc),
         std::move(request),
         std::forward<decltype(handler)>(handler));
     net::dispatch(detail::simple_fetch_op{std::move(s)});
@@ -45,32 +48,45 @@ auto async_fetch(net::any_io_executor ex,
       std::move(request));
 }
 
+namespace detail
+{
+// https requests go through sslc, the others do not need it
+template <typename Response, typename Request, typename CompletionToken>
+auto async_fetch_with_context(net::any_io_executor ex,
+                              net::ssl::context& sslc,
+                              Request request,
+                              CompletionToken&& token)
+{
+  if (http::is_ssl_involved(request.uri()))
+    return fetchpp::async_fetch<Response>(
+        ex, sslc, std::move(request), std::forward<CompletionToken>(token));
+  else
+    return detail::async_fetch<Response>(
+        ex, std::move(request), std::forward<CompletionToken>(token));
+}
+}
+
+// the context of the https requests which are not given one, it is created
+// on first use and shared by the whole process
+net::ssl::context& default_ssl_context();
+
+// requests expecting a plain http::response, or an http::flat_response, go
+// through the pooled client of the executor and reuse its connections
 template <typename Response = http::response,
           typename Request,
           typename CompletionToken>
 auto async_fetch(net::any_io_executor ex, Request request, CompletionToken&& token)
 {
-  if (http::is_ssl_involved(request.uri()))
-  {
-    return net::async_compose<CompletionToken, void(error_code, Response)>(
-        [ex,
-         req = std::move(request),
-         sslc = net::ssl::context(net::ssl::context::tls_client),
-         coro_ = net::coroutine{}](
-            auto& self, error_code ec = {}, Response res = {}) mutable {
-          FETCHPP_REENTER(coro_)
-          {
-            FETCHPP_YIELD async_fetch(ex, sslc, req, std::move(self));
-            self.complete(ec, res);
-          }
-        },
-        token,
-        ex);
-  }
+  if constexpr (std::is_same_v<Response, http::response> ||
+                std::is_same_v<Response, http::flat_response>)
+    return pooled_client(ex).async_fetch(std::move(request),
+                                         Response{},
+                                         std::forward<CompletionToken>(token));
   else
-  {
-    return detail::async_fetch<Response>(
-        ex, std::move(request), std::forward<CompletionToken>(token));
-  }
+    return detail::async_fetch_with_context<Response>(
+        ex,
+        default_ssl_context(),
+        std::move(request),
+        std::forward<CompletionToken>(token));
 }
 }
@@ -5,25 +5,60 @@
 
 #include <fetchpp/http/headers.hpp>
 
+#include <boost/asio/ssl/context.hpp>
+
 #include <fetchpp/alias/strings.hpp>
 
 #include <string_view>
 
 namespace fetchpp
 {
-template <typename CompletionToken>
-auto async_get(net::any_io_executor ex,
-               string_view url_str,
-               http::headers fields,
-               CompletionToken&& token)
+namespace detail
+{
+inline http::request make_get_request(string_view url_str,
+                                      http::headers const& fields)
 {
   auto request = http::request(
       http::verb::get,
       http::url(std::string_view{url_str.data(), url_str.size()}));
   for (auto const& field : fields)
     request.insert(field.field, field.field_name, field.value);
-  return async_fetch(
-      ex, std::move(request), std::forward<CompletionToken>(token));
+  return request;
+}
+}
+
+template <typename CompletionToken>
+auto async_get(net::any_io_executor ex,
+               net::ssl::context& sslc,
+               string_view url_str,
+               http::headers fields,
+               CompletionToken&& token)
+{
+  return detail::async_fetch_with_context<http::response>(
+      ex,
+      sslc,
+      detail::make_get_request(url_str, fields),
+      std::forward<CompletionToken>(token));
+}
+
+template <typename CompletionToken>
+auto async_get(net::any_io_executor ex,
+               net::ssl::context& sslc,
+               string_view url_str,
+               CompletionToken&& token)
+{
+  return async_get(ex, sslc, url_str, {}, std::forward<CompletionToken>(token));
+}
+
+template <typename CompletionToken>
+auto async_get(net::any_io_executor ex,
+               string_view url_str,
+               http::headers fields,
+               CompletionToken&& token)
+{
+  return async_fetch(ex,
+                     detail::make_get_request(url_str, fields),
+                     std::forward<CompletionToken>(token));
 }
 
 template <typename CompletionToken>
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <fetchpp/http/request.hpp>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional/optional.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
+#include <fetchpp/alias/net.hpp>
+
+#include <cstdint>
+#include <utility>
+
+namespace fetchpp::http
+{
+// sends a buffer sequence owned by the caller as it is, the memory it
+// refers to must outlive the request
+template <typename ConstBufferSequence>
+struct buffers_body
+{
+  static_assert(net::is_const_buffer_sequence<ConstBufferSequence>::value,
+                "ConstBufferSequence type requirements not met");
+
+  using value_type = ConstBufferSequence;
+
+  static std::uint64_t size(value_type const& body)
+  {
+    return net::buffer_size(body);
+  }
+
+  class writer
+  {
+  public:
+    using const_buffers_type = ConstBufferSequence;
+
+    template <bool isRequest, typename Fields>
+    writer(beast::http::header<isRequest, Fields> const&,
+           value_type const& body)
+      : body_(body)
+    {
+    }
+
+    void init(error_code& ec)
+    {
+      ec = {};
+    }
+
+    boost::optional<std::pair<const_buffers_type, bool>> get(error_code& ec)
+    {
+      ec = {};
+      if (done_)
+        return boost::none;
+      done_ = true;
+      return std::make_pair(body_, false);
+    }
+
+  private:
+    value_type const& body_;
+    bool done_ = false;
+  };
+};
+
+template <typename ConstBufferSequence = net::const_buffer>
+using buffers_request = body_request<buffers_body<ConstBufferSequence>>;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <fetchpp/http/detail/content_coding.hpp>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/buffers_range.hpp>
+#include <boost/beast/core/buffers_suffix.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional/optional.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
+#include <fetchpp/alias/net.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace fetchpp::http
+{
+// sends a buffer sequence gzipped, as it is compressed. The size of the
+// body is not known up front, the message is sent chunked with
+// Content-Encoding set by its user. The memory the sequence refers to must
+// outlive the message
+template <typename ConstBufferSequence>
+struct compressing_body
+{
+  static_assert(net::is_const_buffer_sequence<ConstBufferSequence>::value,
+                "ConstBufferSequence type requirements not met");
+
+  using value_type = ConstBufferSequence;
+
+  class writer
+  {
+  public:
+    using const_buffers_type = net::const_buffer;
+
+    template <bool isRequest, typename Fields>
+    writer(beast::http::header<isRequest, Fields> const&,
+           value_type const& body)
+      : remaining_(body)
+    {
+    }
+
+    void init(error_code& ec)
+    {
+      ec = {};
+      chunk_ = std::make_unique<char[]>(chunk_size);
+    }
+
+    boost::optional<std::pair<const_buffers_type, bool>> get(error_code& ec)
+    {
+      ec = {};
+      if (encoder_.done())
+        return boost::none;
+      auto const output = net::mutable_buffer(chunk_.get(), chunk_size);
+      std::size_t produced = 0;
+      while (produced < output.size() && !encoder_.done())
+      {
+        auto const input = next_input();
+        auto const [used, made] = encoder_.encode(
+            input,
+            output + produced,
+            input.size() == net::buffer_size(remaining_),
+            ec);
+        if (ec)
+          return boost::none;
+        remaining_.consume(used);
+        produced += made;
+      }
+      return std::make_pair(net::const_buffer(chunk_.get(), produced),
+                            !encoder_.done());
+    }
+
+  private:
+    static constexpr std::size_t chunk_size = 16 * 1024;
+
+    // the sequence may hold empty buffers, they are skipped
+    net::const_buffer next_input() const
+    {
+      for (net::const_buffer buffer : beast::buffers_range_ref(remaining_))
+      {
+        if (buffer.size() > 0)
+          return buffer;
+      }
+      return {};
+    }
+
+    beast::buffers_suffix<ConstBufferSequence> remaining_;
+    detail::content_encoder encoder_;
+    std::unique_ptr<char[]> chunk_;
+  };
+};
+}
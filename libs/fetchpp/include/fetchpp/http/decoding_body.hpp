@@ -0,0 +1,151 @@
+#pragma once
+
+#include <fetchpp/http/detail/content_coding.hpp>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http/basic_dynamic_body.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional/optional.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
+#include <fetchpp/alias/net.hpp>
+#include <fetchpp/alias/strings.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+
+namespace fetchpp::http
+{
+// the encodings a decoding_body undoes, for Accept-Encoding
+inline constexpr char const* decoded_encodings = "gzip, deflate";
+
+// a dynamic body which stores a gzip or deflate body decoded, as its chunks
+// are read, when its value asks for it. Sessions ask for it when the request
+// accepts compressed bodies. Once decoded, the header describes the stored
+// body, see detail::coded_header. The parser body limit bounds the encoded
+// body, the decoded body is bounded by the max_size of the buffer, sessions
+// set it to the body limit of the request, and fails with
+// http::error::body_limit past it. Other bodies are stored as they are
+template <typename DynamicBuffer>
+struct decoding_body
+{
+  class value_type : public DynamicBuffer
+  {
+  public:
+    using DynamicBuffer::DynamicBuffer;
+
+    bool decode_content() const
+    {
+      return decode_content_;
+    }
+    void decode_content(bool decode)
+    {
+      decode_content_ = decode;
+    }
+
+  private:
+    bool decode_content_ = false;
+  };
+
+  using writer =
+      typename beast::http::basic_dynamic_body<DynamicBuffer>::writer;
+
+  static std::uint64_t size(value_type const& body)
+  {
+    return body.size();
+  }
+
+  class reader
+  {
+  public:
+    template <bool isRequest, typename Fields>
+    reader(beast::http::header<isRequest, Fields>& header, value_type& body)
+      : inner_(header, body), body_(body), header_(header)
+    {
+    }
+
+    void init(boost::optional<std::uint64_t> const& length, error_code& ec)
+    {
+      if (!body_.decode_content())
+        return inner_.init(length, ec);
+      // the header is complete by now
+      auto const coding =
+          detail::parse_content_coding(header_.content_encoding());
+      if (!coding || *coding == detail::content_coding::identity)
+        return inner_.init(length, ec);
+      ec = {};
+      decoder_.emplace(*coding);
+    }
+
+    template <typename ConstBufferSequence>
+    std::size_t put(ConstBufferSequence const& buffers, error_code& ec)
+    {
+      if (!decoder_)
+        return inner_.put(buffers, ec);
+      ec = {};
+      std::size_t consumed = 0;
+      for (auto it = net::buffer_sequence_begin(buffers);
+           it != net::buffer_sequence_end(buffers) && !ec;
+           ++it)
+        consumed += decode(*it, ec);
+      return consumed;
+    }
+
+    void finish(error_code& ec)
+    {
+      if (!decoder_)
+        return inner_.finish(ec);
+      ec = {};
+      if (!decoder_->done())
+        ec = beast::http::error::partial_message;
+      else
+        header_.decoded(body_.size());
+    }
+
+  private:
+    static constexpr std::size_t chunk_size = 16 * 1024;
+
+    std::size_t decode(net::const_buffer input, error_code& ec)
+    {
+      std::size_t consumed = 0;
+      // decoded aside once the body is full, to tell whether it goes past
+      // its limit
+      char overflow;
+      while (true)
+      {
+        auto const room = body_.max_size() - body_.size();
+        net::mutable_buffer output(&overflow, 1);
+        if (room != 0)
+        {
+          auto const buffers = body_.prepare(std::min(room, chunk_size));
+          output = *net::buffer_sequence_begin(buffers);
+        }
+        auto const [used, produced] =
+            decoder_->decode(input + consumed, output, ec);
+        consumed += used;
+        if (room == 0 && produced != 0)
+        {
+          ec = beast::http::error::body_limit;
+          break;
+        }
+        body_.commit(produced);
+        if (ec || (used == 0 && produced == 0))
+          break;
+        // the output was filled up, more may be pending
+        if (consumed == input.size() && produced < output.size())
+          break;
+      }
+      return consumed;
+    }
+
+    typename beast::http::basic_dynamic_body<DynamicBuffer>::reader inner_;
+    value_type& body_;
+    detail::coded_header header_;
+    std::optional<detail::content_decoder> decoder_;
+  };
+};
+}
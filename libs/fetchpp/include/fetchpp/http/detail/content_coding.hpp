@@ -0,0 +1,129 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/message.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
+#include <fetchpp/alias/net.hpp>
+#include <fetchpp/alias/strings.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace fetchpp::http::detail
+{
+enum class content_coding
+{
+  identity,
+  gzip,
+  deflate,
+};
+
+// the coding named by a Content-Encoding value, none when a
+// content_decoder cannot undo it
+std::optional<content_coding> parse_content_coding(string_view value);
+
+// the header of a message whose body a reader decodes, whatever its fields
+class coded_header
+{
+public:
+  template <bool isRequest, typename Fields>
+  explicit coded_header(beast::http::header<isRequest, Fields>& header)
+    : header_(&header),
+      content_encoding_([](void const* h) {
+        auto const value =
+            static_cast<beast::http::header<isRequest, Fields> const*>(h)
+                ->operator[](beast::http::field::content_encoding);
+        return string_view(value.data(), value.size());
+      }),
+      decoded_([](void* h, std::uint64_t size) {
+        auto& header = *static_cast<beast::http::header<isRequest, Fields>*>(h);
+        header.erase(beast::http::field::content_encoding);
+        if (header.find(beast::http::field::content_length) != header.end())
+          header.set(beast::http::field::content_length, std::to_string(size));
+      })
+  {
+  }
+
+  string_view content_encoding() const
+  {
+    return content_encoding_(header_);
+  }
+
+  // the header then describes the body as it is stored: Content-Encoding is
+  // dropped, and Content-Length, when the body had one, is its decoded size
+  void decoded(std::uint64_t size)
+  {
+    decoded_(header_, size);
+  }
+
+private:
+  void* header_;
+  string_view (*content_encoding_)(void const*);
+  void (*decoded_)(void*, std::uint64_t);
+};
+
+// inflates a gzip or deflate body as its chunks arrive
+class content_decoder
+{
+public:
+  explicit content_decoder(content_coding coding);
+  ~content_decoder();
+
+  content_decoder(content_decoder const&) = delete;
+  content_decoder& operator=(content_decoder const&) = delete;
+
+  // decodes as much of input as output can take. Returns the bytes consumed
+  // from input and produced in output, what follows the end of the body is
+  // consumed and dropped
+  std::pair<std::size_t, std::size_t> decode(net::const_buffer input,
+                                             net::mutable_buffer output,
+                                             error_code& ec);
+
+  // whether the end of the encoded body was reached
+  bool done() const;
+
+private:
+  struct stream;
+
+  std::unique_ptr<stream> stream_;
+  content_coding coding_;
+  // some servers send deflate bodies without their zlib header
+  bool raw_ = false;
+  bool done_ = false;
+};
+
+// gzips a body, chunk by chunk
+class content_encoder
+{
+public:
+  content_encoder();
+  ~content_encoder();
+
+  content_encoder(content_encoder const&) = delete;
+  content_encoder& operator=(content_encoder const&) = delete;
+
+  // encodes as much of input as output can take, last tells that no input
+  // follows. Returns the bytes consumed from input and produced in output
+  std::pair<std::size_t, std::size_t> encode(net::const_buffer input,
+                                             net::mutable_buffer output,
+                                             bool last,
+                                             error_code& ec);
+
+  // whether the whole encoded body was produced
+  bool done() const;
+
+private:
+  struct stream;
+
+  std::unique_ptr<stream> stream_;
+  bool done_ = false;
+};
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <boost/beast/core/error.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/strings.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fetchpp::http::detail
+{
+using json_sax = nlohmann::json_sax<nlohmann::json>;
+
+// builds a document from the events of a json_push_parser
+class json_builder final : public json_sax
+{
+public:
+  explicit json_builder(nlohmann::json& root);
+
+  bool null() override;
+  bool boolean(bool val) override;
+  bool number_integer(number_integer_t val) override;
+  bool number_unsigned(number_unsigned_t val) override;
+  bool number_float(number_float_t val, string_t const& s) override;
+  bool string(string_t& val) override;
+  bool binary(binary_t& val) override;
+  bool start_object(std::size_t elements) override;
+  bool key(string_t& val) override;
+  bool end_object() override;
+  bool start_array(std::size_t elements) override;
+  bool end_array() override;
+  bool parse_error(std::size_t position,
+                   std::string const& last_token,
+                   nlohmann::detail::exception const& ex) override;
+
+private:
+  template <typename Value>
+  nlohmann::json* add(Value&& value);
+
+  nlohmann::json& root_;
+  std::vector<nlohmann::json*> containers_;
+  nlohmann::json* member_ = nullptr;
+};
+
+// parses a json document pushed chunk by chunk, sending its events to a sax
+// handler as soon as they are complete. Malformed json fails with
+// errc::bad_message, the parse_error event is not sent. Once the handler
+// returns false, the rest of the input is ignored
+class json_push_parser
+{
+public:
+  explicit json_push_parser(json_sax& sax);
+
+  void write(string_view input, error_code& ec);
+  // the document must be complete, or not started at all
+  void finish(error_code& ec);
+
+  // whether the handler stopped the parsing
+  bool stopped() const;
+
+private:
+  enum class state : std::uint8_t
+  {
+    value,
+    first_value,
+    first_key,
+    key,
+    colon,
+    next,
+    string,
+    escape,
+    unicode,
+    number,
+    literal,
+    end,
+  };
+
+  void step(char c, error_code& ec);
+  void start_value(char c, error_code& ec);
+  void string_char(char c, error_code& ec);
+  void escape_char(char c, error_code& ec);
+  void unicode_char(char c, error_code& ec);
+  void end_string();
+  void end_number(error_code& ec);
+  void end_container(bool object, error_code& ec);
+  void value_done();
+  void emit(bool keep_going);
+
+  json_sax& sax_;
+  // the opened containers, true for objects
+  std::vector<bool> containers_;
+  std::string token_;
+  char const* literal_ = nullptr;
+  std::size_t literal_size_ = 0;
+  std::uint32_t code_point_ = 0;
+  std::uint32_t high_surrogate_ = 0;
+  int hex_digits_ = 0;
+  int utf8_pending_ = 0;
+  // the range of the next continuation byte of a utf-8 sequence
+  std::uint8_t utf8_low_ = 0x80;
+  std::uint8_t utf8_high_ = 0xBF;
+  state state_ = state::value;
+  bool key_ = false;
+  bool started_ = false;
+  bool stopped_ = false;
+};
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional/optional.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
+#include <fetchpp/alias/net.hpp>
+
+#include <cstdint>
+
+namespace fetchpp::http
+{
+namespace detail
+{
+// reserves size bytes from the current position of the file, descriptors
+// which cannot reserve space are left as they are
+void preallocate(int fd, std::uint64_t size, error_code& ec);
+void write_all(int fd, net::const_buffer buffer, error_code& ec);
+}
+
+// writes the body of a response to a file descriptor, from its current
+// position, as it is read. The space announced by Content-Length is
+// reserved up front. On a plain tcp connection the body is moved from the
+// socket to a regular file without going through user space
+struct fd_body
+{
+  struct value_type
+  {
+    // the descriptor is not owned by the body
+    int fd = -1;
+    // bytes written for the last response
+    std::uint64_t delivered = 0;
+  };
+
+  class reader
+  {
+  public:
+    template <bool isRequest, typename Fields>
+    reader(beast::http::header<isRequest, Fields>&, value_type& body)
+      : body_(body)
+    {
+    }
+
+    void init(boost::optional<std::uint64_t> const& length, error_code& ec)
+    {
+      body_.delivered = 0;
+      ec = {};
+      if (length)
+        detail::preallocate(body_.fd, *length, ec);
+    }
+
+    template <typename ConstBufferSequence>
+    std::size_t put(ConstBufferSequence const& buffers, error_code& ec)
+    {
+      ec = {};
+      std::size_t written = 0;
+      for (auto it = net::buffer_sequence_begin(buffers);
+           it != net::buffer_sequence_end(buffers) && !ec;
+           ++it)
+      {
+        net::const_buffer buffer = *it;
+        detail::write_all(body_.fd, buffer, ec);
+        if (!ec)
+          written += buffer.size();
+      }
+      body_.delivered += written;
+      return written;
+    }
+
+    void finish(error_code& ec)
+    {
+      ec = {};
+    }
+
+  private:
+    value_type& body_;
+  };
+};
+
+using fd_response = beast::http::response<fd_body>;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <fetchpp/http/request.hpp>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional/optional.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
+#include <fetchpp/alias/net.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace fetchpp::http
+{
+namespace detail
+{
+// a range of a file mapped in memory, read only
+class file_mapping
+{
+public:
+  file_mapping() = default;
+  ~file_mapping();
+
+  file_mapping(file_mapping const&) = delete;
+  file_mapping& operator=(file_mapping const&) = delete;
+
+  void map(int fd, std::uint64_t offset, std::uint64_t size, error_code& ec);
+  net::const_buffer data() const;
+
+private:
+  void* base_ = nullptr;
+  std::size_t length_ = 0;
+  std::size_t skip_ = 0;
+};
+}
+
+// sends a range of a file, the descriptor is not owned by the body and its
+// position is left as it is. On a plain tcp connection the range goes from
+// the file to the socket with sendfile, otherwise it is mapped in memory
+// and written from there
+struct fd_source_body
+{
+  struct value_type
+  {
+    int fd = -1;
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+  };
+
+  static std::uint64_t size(value_type const& body)
+  {
+    return body.size;
+  }
+
+  class writer
+  {
+  public:
+    using const_buffers_type = net::const_buffer;
+
+    template <bool isRequest, typename Fields>
+    writer(beast::http::header<isRequest, Fields> const&,
+           value_type const& body)
+      : body_(body)
+    {
+    }
+
+    void init(error_code& ec)
+    {
+      ec = {};
+    }
+
+    // the file is mapped on first use, a header written alone does not
+    // need it
+    boost::optional<std::pair<const_buffers_type, bool>> get(error_code& ec)
+    {
+      ec = {};
+      if (done_)
+        return boost::none;
+      done_ = true;
+      mapping_.map(body_.fd, body_.offset, body_.size, ec);
+      if (ec)
+        return boost::none;
+      return std::make_pair(mapping_.data(), false);
+    }
+
+  private:
+    value_type const& body_;
+    detail::file_mapping mapping_;
+    bool done_ = false;
+  };
+};
+
+using fd_request = body_request<fd_source_body>;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <fetchpp/http/detail/content_coding.hpp>
+#include <fetchpp/http/detail/json_parser.hpp>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional/optional.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
+#include <fetchpp/alias/net.hpp>
+#include <fetchpp/alias/strings.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace fetchpp::http
+{
+// parses the json body of a response as its chunks are read, so that the
+// parsing overlaps with the transfer. The document is built into value, or
+// its events are sent to sax when one is given. A gzip or deflate body is
+// decoded first when value_type::decode_content() asks for it, as sessions do
+// when the request accepts compressed bodies, and bounded by
+// value_type::max_size. An empty body leaves
+// value null, malformed json fails the response with errc::bad_message
+struct json_body
+{
+  using sax_type = nlohmann::json_sax<nlohmann::json>;
+
+  struct value_type
+  {
+    nlohmann::json value;
+    // not owned, it must outlive the exchange. The rest of the body is
+    // read but not parsed once it returns false
+    sax_type* sax = nullptr;
+    // bytes of the body read for the last response
+    std::uint64_t delivered = 0;
+
+    value_type() = default;
+    value_type(sax_type& s) : sax(&s)
+    {
+    }
+
+    // bounds the decoded body, past it the response fails with
+    // http::error::body_limit. Sessions set it to the body limit of the
+    // request
+    std::size_t max_size() const
+    {
+      return max_size_;
+    }
+    void max_size(std::size_t n)
+    {
+      max_size_ = n;
+    }
+
+    bool decode_content() const
+    {
+      return decode_content_;
+    }
+    void decode_content(bool decode)
+    {
+      decode_content_ = decode;
+    }
+
+  private:
+    std::size_t max_size_ = std::numeric_limits<std::size_t>::max();
+    bool decode_content_ = false;
+  };
+
+  class reader
+  {
+  public:
+    template <bool isRequest, typename Fields>
+    reader(beast::http::header<isRequest, Fields>& header, value_type& body)
+      : body_(body), header_(header)
+    {
+    }
+
+    void init(boost::optional<std::uint64_t> const&, error_code& ec)
+    {
+      ec = {};
+      body_.delivered = 0;
+      body_.value = nullptr;
+      decoded_size_ = 0;
+      if (body_.sax)
+        parser_.emplace(*body_.sax);
+      else
+        parser_.emplace(builder_.emplace(body_.value));
+      if (!body_.decode_content())
+        return;
+      // the header is complete by now
+      auto const coding =
+          detail::parse_content_coding(header_.content_encoding());
+      if (coding && *coding != detail::content_coding::identity)
+      {
+        decoder_.emplace(*coding);
+        decoded_.resize(chunk_size);
+      }
+    }
+
+    template <typename ConstBufferSequence>
+    std::size_t put(ConstBufferSequence const& buffers, error_code& ec)
+    {
+      ec = {};
+      std::size_t consumed = 0;
+      for (auto it = net::buffer_sequence_begin(buffers);
+           it != net::buffer_sequence_end(buffers) && !ec;
+           ++it)
+        consumed += parse(*it, ec);
+      body_.delivered += consumed;
+      return consumed;
+    }
+
+    void finish(error_code& ec)
+    {
+      ec = {};
+      // the response has no body, init was not called
+      if (!parser_)
+        body_.value = nullptr;
+      else if (decoder_ && !decoder_->done())
+        ec = beast::http::error::partial_message;
+      else
+      {
+        if (decoder_)
+          header_.decoded(decoded_size_);
+        parser_->finish(ec);
+      }
+    }
+
+  private:
+    static constexpr std::size_t chunk_size = 16 * 1024;
+
+    std::size_t parse(net::const_buffer input, error_code& ec)
+    {
+      if (!decoder_)
+      {
+        write(
+            string_view(static_cast<char const*>(input.data()), input.size()),
+            ec);
+        return input.size();
+      }
+      std::size_t consumed = 0;
+      while (true)
+      {
+        auto const [used, produced] = decoder_->decode(
+            input + consumed, net::buffer(decoded_), ec);
+        consumed += used;
+        if (!ec)
+          write(string_view(decoded_.data(), produced), ec);
+        if (ec || (used == 0 && produced == 0))
+          break;
+        // the output was filled up, more may be pending
+        if (consumed == input.size() && produced < decoded_.size())
+          break;
+      }
+      return consumed;
+    }
+
+    void write(string_view decoded, error_code& ec)
+    {
+      if (decoded.size() > body_.max_size() - decoded_size_)
+      {
+        ec = beast::http::error::body_limit;
+        return;
+      }
+      decoded_size_ += decoded.size();
+      parser_->write(decoded, ec);
+    }
+
+    value_type& body_;
+    detail::coded_header header_;
+    std::optional<detail::json_builder> builder_;
+    std::optional<detail::json_push_parser> parser_;
+    std::optional<detail::content_decoder> decoder_;
+    std::vector<char> decoded_;
+    std::size_t decoded_size_ = 0;
+  };
+};
+
+using json_response = beast::http::response<json_body>;
+}
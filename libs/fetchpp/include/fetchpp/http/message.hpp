@@ -2,6 +2,7 @@
 
 #include <fetchpp/http/authorization.hpp>
 #include <fetchpp/http/content_type.hpp>
+#include <fetchpp/http/decoding_body.hpp>
 
 #include <boost/beast/core/buffers_cat.hpp>
 #include <boost/beast/core/buffers_to_string.hpp>
@@ -9,6 +10,7 @@
 #include <boost/beast/http/message.hpp>
 
 #include <boost/asio/buffer.hpp>
+#include <boost/asio/buffers_iterator.hpp>
 #include <boost/beast/http/fields.hpp>
 
 #include <nlohmann/json.hpp>
@@ -19,15 +21,35 @@
 
 #include <charconv>
 #include <optional>
+#include <type_traits>
 
 namespace fetchpp::http
 {
 namespace detail
 {
+// a response body is decoded when its request accepts compressed bodies,
+// a request body is sent as it is stored
 template <bool isRequest, typename DynamicBuffer>
-using dynamic_body_message =
-    beast::http::message<isRequest,
-                         beast::http::basic_dynamic_body<DynamicBuffer>>;
+using dynamic_body_message = beast::http::message<
+    isRequest,
+    std::conditional_t<isRequest,
+                       beast::http::basic_dynamic_body<DynamicBuffer>,
+                       http::decoding_body<DynamicBuffer>>>;
+
+// calls parse with a character range over the buffers, without copying them.
+// A contiguous body is read through plain pointers
+template <typename ConstBufferSequence, typename Parse>
+auto parse_buffers(ConstBufferSequence const& buffers, Parse&& parse)
+{
+  if constexpr (std::is_convertible_v<ConstBufferSequence, net::const_buffer>)
+  {
+    net::const_buffer const buffer = buffers;
+    auto const first = static_cast<char const*>(buffer.data());
+    return parse(first, first + buffer.size());
+  }
+  else
+    return parse(net::buffers_begin(buffers), net::buffers_end(buffers));
+}
 }
 
 template <bool isRequest, typename DynamicBuffer>
@@ -67,7 +89,12 @@ public:
   bool is_content() const;
   bool is_content_type(string_view type) const;
 
+  // the body is parsed where it is stored
   auto json() const -> nlohmann::json;
+  // the body is parsed as events sent to sax, see nlohmann::json_sax. Returns
+  // false when sax stopped the parsing, or on a parse error reported to it
+  template <typename SAX>
+  bool json(SAX& sax) const;
   auto text() const -> std::string;
   auto content() const -> beast::buffers_cat_view<
       typename base_t::body_type::value_type::const_buffers_type>;
@@ -196,7 +223,19 @@ auto message<isRequest, DynamicBuffer>::content() const
 template <bool isRequest, typename DynamicBuffer>
 auto message<isRequest, DynamicBuffer>::json() const -> nlohmann::json
 {
-  return nlohmann::json::parse(this->text());
+  return detail::parse_buffers(this->body().cdata(), [](auto first, auto last) {
+    return nlohmann::json::parse(first, last);
+  });
+}
+
+template <bool isRequest, typename DynamicBuffer>
+template <typename SAX>
+bool message<isRequest, DynamicBuffer>::json(SAX& sax) const
+{
+  return detail::parse_buffers(
+      this->body().cdata(), [&sax](auto first, auto last) {
+        return nlohmann::json::sax_parse(first, last, &sax);
+      });
 }
 
 template <bool isRequest, typename DynamicBuffer>
@@ -1,61 +1,161 @@
 #pragma once
 
+#include <fetchpp/http/decoding_body.hpp>
 #include <fetchpp/http/detail/request.hpp>
 #include <fetchpp/http/message.hpp>
 #include <fetchpp/http/url.hpp>
 
 #include <boost/beast/core/multi_buffer.hpp>
+#include <boost/beast/http/message.hpp>
 #include <boost/beast/http/verb.hpp>
 
 #include <fetchpp/alias/http.hpp>
 #include <fetchpp/alias/strings.hpp>
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 
 namespace fetchpp::http
 {
+// what a session needs to know of a request besides its message
+class request_options
+{
+public:
+  explicit request_options(url uri);
+
+  url const& uri() const;
+
+  // bounds the whole processing of the request by a session: queueing,
+  // connection, TLS handshake and transfer. Only this request fails with
+  // beast::error::timeout when it expires
+  std::optional<std::chrono::nanoseconds> timeout() const;
+  void set_timeout(std::chrono::nanoseconds timeout);
+
+  // sessions serve the requests of higher priority first, 0 by default
+  int priority() const;
+  void set_priority(int priority);
+
+  // the response fails with beast::http::error::body_limit when its body is
+  // larger, as sent or once decoded. std::nullopt lifts the limit. Unless
+  // it is set, a body kept in memory is bounded by default_body_limit, a
+  // body streamed to a sink or written to a file is not bounded
+  static constexpr std::uint64_t default_body_limit = 80 * 1024 * 1024;
+  std::optional<std::uint64_t> body_limit() const;
+  void set_body_limit(std::optional<std::uint64_t> limit);
+  bool body_limit_is_set() const;
+
+  // sessions send a dynamic body of at least this size gzipped, as it is
+  // compressed, unless its Content-Encoding is already set. std::nullopt,
+  // the default, sends every body as it is
+  std::optional<std::size_t> compression_threshold() const;
+  void set_compression_threshold(std::optional<std::size_t> threshold);
+
+  // whether accept_compressed() was called, sessions then decode a gzip or
+  // deflate response body. Other responses are stored as they are sent
+  bool accepts_compressed() const;
+
+protected:
+  bool _accepts_compressed = false;
+
+private:
+  url _uri;
+  std::optional<std::chrono::nanoseconds> _timeout;
+  int _priority = 0;
+  std::optional<std::uint64_t> _body_limit = default_body_limit;
+  bool _body_limit_is_set = false;
+  std::optional<std::size_t> _compression_threshold;
+};
+
 template <typename DynamicBuffer>
-class basic_request : public message<true, DynamicBuffer>
+class basic_request : public message<true, DynamicBuffer>,
+                      public request_options
 {
   using base_t = message<true, DynamicBuffer>;
 
 public:
   basic_request(http::verb verb, url uri);
 
-  url const& uri() const;
   void accept(string_view ct);
   void accept(http::content_type const& ct);
+  // asks for a compressed body, which sessions decode as it is read
+  void accept_compressed();
+};
 
-private:
-  url _uri;
+// a request whose body is not copied into a dynamic buffer, see
+// http::buffers_body and http::fd_source_body
+template <typename Body>
+class body_request : public beast::http::request<Body>, public request_options
+{
+  using base_t = beast::http::request<Body>;
+
+public:
+  body_request(http::verb verb, url uri, typename Body::value_type body);
+
+  void accept(string_view ct);
+  void accept(http::content_type const& ct);
+  // asks for a compressed body, which sessions decode as it is read
+  void accept_compressed();
 };
 
 // =================
 
 template <typename DynamicBuffer>
 basic_request<DynamicBuffer>::basic_request(http::verb verb, url uri)
-  : base_t(verb, uri.target(), 11), _uri(std::move(uri))
+  : base_t(verb, uri.target(), 11), request_options(std::move(uri))
 {
-  detail::set_options(_uri.host(), *this);
+  detail::set_options(this->uri().host(), *this);
 }
 
 template <typename DynamicBuffer>
-url const& basic_request<DynamicBuffer>::uri() const
+void basic_request<DynamicBuffer>::accept(string_view ct)
 {
-  return _uri;
+  this->set(http::field::accept, ct);
 }
 
 template <typename DynamicBuffer>
-void basic_request<DynamicBuffer>::accept(string_view ct)
+void basic_request<DynamicBuffer>::accept(http::content_type const& ct)
 {
-  this->set(http::field::accept, ct);
+  this->set(http::field::accept, to_string(ct));
 }
 
 template <typename DynamicBuffer>
-void basic_request<DynamicBuffer>::accept(http::content_type const& ct)
+void basic_request<DynamicBuffer>::accept_compressed()
+{
+  this->set(http::field::accept_encoding, decoded_encodings);
+  this->_accepts_compressed = true;
+}
+
+template <typename Body>
+body_request<Body>::body_request(http::verb verb,
+                                 url uri,
+                                 typename Body::value_type body)
+  : base_t(verb, uri.target(), 11, std::move(body)),
+    request_options(std::move(uri))
+{
+  detail::set_options(this->uri().host(), *this);
+  this->prepare_payload();
+}
+
+template <typename Body>
+void body_request<Body>::accept(string_view ct)
+{
+  this->set(http::field::accept, ct);
+}
+
+template <typename Body>
+void body_request<Body>::accept(http::content_type const& ct)
 {
   this->set(http::field::accept, to_string(ct));
 }
 
+template <typename Body>
+void body_request<Body>::accept_compressed()
+{
+  this->set(http::field::accept_encoding, decoded_encodings);
+  this->_accepts_compressed = true;
+}
+
 using request = basic_request<beast::multi_buffer>;
 }
@@ -4,6 +4,7 @@
 
 #include <fetchpp/http/message.hpp>
 
+#include <boost/beast/core/flat_buffer.hpp>
 #include <boost/beast/core/multi_buffer.hpp>
 
 #include <fetchpp/alias/http.hpp>
@@ -32,4 +33,6 @@ public:
 };
 
 using response = basic_response<beast::multi_buffer>;
+// the body is stored contiguously, text() and json() read it in one piece
+using flat_response = basic_response<beast::flat_buffer>;
 }
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional/optional.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/http.hpp>
+#include <fetchpp/alias/net.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace fetchpp::http
+{
+// hands the body of a response to a sink as it is read instead of storing
+// it. No more of the body is read before the sink is done with a chunk, a
+// slow sink slows the transfer down and the memory used does not depend on
+// the size of the body. There is no body limit unless the request sets one
+struct streaming_body
+{
+  // the sink sets the error code to stop the transfer, the response then
+  // fails with it and its connection is closed
+  using sink_type = std::function<void(net::const_buffer, error_code&)>;
+  // the sink calls the handler once done with the chunk, which stays valid
+  // until then. The session is free in the meantime, the sink can wait on
+  // other asynchronous operations. An error passed to the handler stops the
+  // transfer like sink_type does. An aborted request completes once the
+  // handler is called
+  using async_sink_type = std::function<void(
+      net::const_buffer, std::function<void(error_code)> handler)>;
+
+  struct value_type
+  {
+    sink_type sink;
+    // replaces sink when set. Sessions read the body a chunk at a time for
+    // it, other readers only collect the chunks into pending
+    async_sink_type async_sink;
+    // bytes handed to the sink for the last response
+    std::uint64_t delivered = 0;
+    // what was read and is not yet handed to async_sink, managed by the
+    // session
+    beast::flat_buffer pending;
+
+    value_type() = default;
+    value_type(sink_type s) : sink(std::move(s))
+    {
+    }
+    value_type(async_sink_type s) : async_sink(std::move(s))
+    {
+    }
+  };
+
+  class reader
+  {
+  public:
+    template <bool isRequest, typename Fields>
+    reader(beast::http::header<isRequest, Fields>&, value_type& body)
+      : body_(body)
+    {
+    }
+
+    void init(boost::optional<std::uint64_t> const&, error_code& ec)
+    {
+      body_.delivered = 0;
+      body_.pending.clear();
+      ec = {};
+    }
+
+    template <typename ConstBufferSequence>
+    std::size_t put(ConstBufferSequence const& buffers, error_code& ec)
+    {
+      ec = {};
+      std::size_t consumed = 0;
+      for (auto it = net::buffer_sequence_begin(buffers);
+           it != net::buffer_sequence_end(buffers) && !ec;
+           ++it)
+      {
+        net::const_buffer buffer = *it;
+        if (body_.async_sink)
+          body_.pending.commit(net::buffer_copy(
+              body_.pending.prepare(buffer.size()), buffer));
+        else if (body_.sink)
+          body_.sink(buffer, ec);
+        consumed += buffer.size();
+      }
+      body_.delivered += consumed;
+      return consumed;
+    }
+
+    void finish(error_code& ec)
+    {
+      ec = {};
+    }
+
+  private:
+    value_type& body_;
+  };
+};
+
+using streaming_response = beast::http::response<streaming_body>;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <fetchpp/client.hpp>
+
+#include <fetchpp/alias/net.hpp>
+
+namespace fetchpp
+{
+// the client behind the free fetch functions, there is one per execution
+// context and it is destroyed with it.
+// it keeps the connections alive between requests and can be configured
+// like any other client.
+client& pooled_client(net::any_io_executor ex);
+}
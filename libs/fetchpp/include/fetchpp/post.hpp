@@ -5,25 +5,67 @@
 #include <fetchpp/http/headers.hpp>
 
 #include <boost/asio/buffer.hpp>
+#include <boost/asio/ssl/context.hpp>
 
 #include <fetchpp/alias/net.hpp>
 #include <fetchpp/alias/strings.hpp>
 
 namespace fetchpp
 {
+namespace detail
+{
+inline http::request make_post_request(std::string_view url_str,
+                                       net::const_buffer body,
+                                       http::headers const& fields)
+{
+  auto request = http::request(http::verb::post, http::url(url_str));
+  request.content(body);
+  for (auto const& field : fields)
+    request.insert(field.field, field.field_name, field.value);
+  return request;
+}
+}
+
 template <typename CompletionToken>
 auto async_post(net::any_io_executor ex,
+                net::ssl::context& sslc,
                 std::string_view url_str,
                 net::const_buffer body,
                 http::headers fields,
                 CompletionToken&& token)
 {
-  auto request = http::request(http::verb::post, http::url(url_str));
-  request.content(body);
-  for (auto const& field : fields)
-    request.insert(field.field, field.field_name, field.value);
-  return async_fetch(
-      ex, std::move(request), std::forward<CompletionToken>(token));
+  return detail::async_fetch_with_context<http::response>(
+      ex,
+      sslc,
+      detail::make_post_request(url_str, body, fields),
+      std::forward<CompletionToken>(token));
+}
+
+template <typename CompletionToken>
+auto async_post(net::any_io_executor ex,
+                net::ssl::context& sslc,
+                string_view url_str,
+                net::const_buffer body,
+                CompletionToken&& token)
+{
+  return async_post(ex,
+                    sslc,
+                    url_str,
+                    std::move(body),
+                    {},
+                    std::forward<CompletionToken>(token));
+}
+
+template <typename CompletionToken>
+auto async_post(net::any_io_executor ex,
+                std::string_view url_str,
+                net::const_buffer body,
+                http::headers fields,
+                CompletionToken&& token)
+{
+  return async_fetch(ex,
+                     detail::make_post_request(url_str, body, fields),
+                     std::forward<CompletionToken>(token));
 }
 
 template <typename CompletionToken>
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <fetchpp/client.hpp>
+#include <fetchpp/http/proxy.hpp>
+#include <fetchpp/http/url.hpp>
+
+#include <boost/asio/compose.hpp>
+#include <boost/asio/ssl/context.hpp>
+
+#include <fetchpp/alias/error_code.hpp>
+#include <fetchpp/alias/net.hpp>
+#include <fetchpp/alias/ssl.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace fetchpp
+{
+namespace detail
+{
+template <typename ShardedClient>
+struct sharded_client_stop_op
+{
+  ShardedClient& client_;
+  GracefulShutdown graceful_;
+  std::size_t next_ = 0;
+  error_code last_ec_ = {};
+
+  template <typename Self>
+  void operator()(Self& self, error_code ec = {})
+  {
+    if (ec)
+      last_ec_ = ec;
+    if (next_ == client_.shard_count())
+    {
+      self.complete(last_ec_);
+      return;
+    }
+    client_.shard(next_++).async_stop(graceful_, std::move(self));
+  }
+};
+template <typename ShardedClient>
+sharded_client_stop_op(ShardedClient&, GracefulShutdown)
+    -> sharded_client_stop_op<ShardedClient>;
+}
+
+// a set of independent clients, each with its own strand and sessions.
+// requests are routed to a shard by endpoint, so that all the requests to
+// one endpoint share the same connections
+class sharded_client
+{
+public:
+  using context_factory = std::function<net::ssl::context()>;
+
+  sharded_client(net::any_io_executor ex,
+                 std::size_t shards,
+                 std::chrono::nanoseconds = std::chrono::seconds(30));
+  sharded_client(net::io_context& ioc,
+                 std::size_t shards,
+                 std::chrono::nanoseconds = std::chrono::seconds(30));
+  sharded_client(net::any_io_executor ex,
+                 std::size_t shards,
+                 std::chrono::nanoseconds,
+                 context_factory make_context);
+
+  std::size_t shard_count() const;
+  client& shard(std::size_t index);
+  client const& shard(std::size_t index) const;
+  client& shard_for(http::url const& uri);
+
+  std::size_t session_count() const;
+  // settings are forwarded to every shard, limits apply to each of them
+  void set_max_pending_per_session(std::size_t pending);
+  void set_max_sessions(std::size_t max);
+  void set_max_sessions_per_host(std::size_t max);
+  void set_idle_timeout(std::chrono::nanoseconds timeout);
+  void set_session_selection(session_selection policy);
+  void set_pipeline_depth(std::size_t depth);
+  void set_retry_policy(retry_policy const& policy);
+  void set_priority_threshold(std::optional<int> threshold);
+  void set_priority_sessions_per_host(std::size_t max);
+  void set_priority_aging(std::chrono::nanoseconds period);
+  void set_verify_peer(bool v);
+  void add_proxy(http::proxy_match, http::proxy);
+  void set_proxies(http::proxy_map);
+
+  template <typename CompletionToken>
+  auto async_stop(GracefulShutdown graceful, CompletionToken&& token)
+  {
+    return net::async_compose<CompletionToken, void(error_code)>(
+        detail::sharded_client_stop_op{*this, graceful}, token, ex_);
+  }
+
+  template <typename CompletionToken>
+  auto async_stop(CompletionToken&& token)
+  {
+    return async_stop(GracefulShutdown::Yes,
+                      std::forward<CompletionToken>(token));
+  }
+
+  template <typename Request, typename CompletionToken>
+  auto async_fetch(Request request, CompletionToken&& token)
+  {
+    auto& target = shard_for(request.uri());
+    return target.async_fetch(std::move(request),
+                              std::forward<CompletionToken>(token));
+  }
+
+  template <typename Request, typename Response, typename CompletionToken>
+  auto async_fetch(Request request, Response response, CompletionToken&& token)
+  {
+    auto& target = shard_for(request.uri());
+    return target.async_fetch(std::move(request),
+                              std::move(response),
+                              std::forward<CompletionToken>(token));
+  }
+
+private:
+  net::any_io_executor ex_;
+  std::vector<std::unique_ptr<client>> shards_;
+};
+}
@@ -1,10 +1,13 @@
 #include <fetchpp/client.hpp>
 
+#include <boost/asio/bind_executor.hpp>
+
+#include <utility>
+
 namespace fetchpp
 {
-namespace detail
-{
-}
+using detail::session_base;
+
 client::client(net::any_io_executor ex, std::chrono::nanoseconds timeout)
   : client(ex, timeout, net::ssl::context(net::ssl::context::tlsv12_client))
 {
@@ -18,8 +21,18 @@ client::client(net::io_context& ioc, std::chrono::nanoseconds timeout)
 client::client(net::any_io_executor ex,
                std::chrono::nanoseconds timeout,
                net::ssl::context context)
-  : strand_(ex), timeout_(timeout), context_(std::move(context))
+  : strand_(ex),
+    pool_(std::make_shared<detail::recycling_pool>()),
+    timeout_(timeout),
+    retry_budget_(std::make_shared<retry_budget>(
+        retry_policy_.budget_ratio, retry_policy_.budget_reserve)),
+    context_(std::move(context)),
+    dns_cache_(std::make_shared<fetchpp::dns_cache>(ex)),
+    ssl_session_cache_(std::make_shared<fetchpp::ssl_session_cache>()),
+    retired_drained_(strand_),
+    reaper_(strand_)
 {
+  fetchpp::ssl_session_cache::attach(context_);
 }
 
 client::client(net::io_context& ioc,
@@ -33,6 +46,11 @@ void client::set_verify_peer(bool v)
 {
   this->context_.set_verify_mode(v ? net::ssl::verify_peer :
                                      net::ssl::verify_none);
+  // sessions negotiated under the former mode must not be resumed
+  net::post(this->strand_, [this]() {
+    if (this->ssl_session_cache_)
+      this->ssl_session_cache_->clear();
+  });
 }
 
 auto client::get_internal_executor() const -> internal_executor_type
@@ -60,6 +78,287 @@ std::size_t client::session_count() const
   return sessions_.size();
 }
 
+std::size_t client::max_sessions() const
+{
+  return max_sessions_;
+}
+
+void client::set_max_sessions(std::size_t max)
+{
+  max_sessions_ = max;
+}
+
+std::size_t client::max_sessions_per_host() const
+{
+  return max_sessions_per_host_;
+}
+
+void client::set_max_sessions_per_host(std::size_t max)
+{
+  max_sessions_per_host_ = max;
+}
+
+std::size_t client::waiting_requests() const
+{
+  return waiters_.size();
+}
+
+session_selection client::selection() const
+{
+  return selection_;
+}
+
+void client::set_session_selection(session_selection policy)
+{
+  selection_ = policy;
+}
+
+std::size_t client::pipeline_depth() const
+{
+  return pipeline_depth_;
+}
+
+void client::set_pipeline_depth(std::size_t depth)
+{
+  pipeline_depth_ = depth;
+}
+
+std::shared_ptr<detail::recycling_pool> const& client::memory_pool() const
+{
+  return pool_;
+}
+
+std::size_t client::allocations() const
+{
+  return pool_->allocations();
+}
+
+std::optional<int> client::priority_threshold() const
+{
+  return priority_threshold_;
+}
+
+void client::set_priority_threshold(std::optional<int> threshold)
+{
+  priority_threshold_ = threshold;
+}
+
+std::size_t client::priority_sessions_per_host() const
+{
+  return priority_sessions_per_host_;
+}
+
+void client::set_priority_sessions_per_host(std::size_t max)
+{
+  priority_sessions_per_host_ = max;
+}
+
+std::chrono::nanoseconds client::priority_aging() const
+{
+  return priority_aging_;
+}
+
+void client::set_priority_aging(std::chrono::nanoseconds period)
+{
+  priority_aging_ = period;
+}
+
+fetchpp::retry_policy const& client::get_retry_policy() const
+{
+  return retry_policy_;
+}
+
+void client::set_retry_policy(fetchpp::retry_policy policy)
+{
+  net::post(this->strand_, [p = std::move(policy), this]() mutable {
+    this->retry_budget_ =
+        std::make_shared<retry_budget>(p.budget_ratio, p.budget_reserve);
+    this->retry_policy_ = std::move(p);
+    for (auto& adapter : sessions_)
+      boost::variant2::visit(
+          [&](auto& session) {
+            session.set_retry_policy(retry_policy_, retry_budget_);
+          },
+          adapter);
+  });
+}
+
+std::shared_ptr<retry_budget> const& client::get_retry_budget() const
+{
+  return retry_budget_;
+}
+
+std::vector<std::size_t> client::pending_tasks_per_session() const
+{
+  std::vector<std::size_t> pending;
+  pending.reserve(sessions_.size());
+  for (auto const& adapter : sessions_)
+    boost::variant2::visit(
+        [&](auto const& session) {
+          pending.push_back(session.pending_tasks());
+        },
+        adapter);
+  return pending;
+}
+
+std::chrono::nanoseconds client::idle_timeout() const
+{
+  return idle_timeout_;
+}
+
+void client::set_idle_timeout(std::chrono::nanoseconds timeout)
+{
+  net::post(this->strand_, [timeout, this] {
+    this->idle_timeout_ = timeout;
+    this->cancel_reaper();
+    this->arm_reaper();
+  });
+}
+
+std::uint64_t client::wait_for_session(detail::task::ptr_t waiter)
+{
+  BOOST_ASSERT(strand_.running_in_this_thread());
+  if (waiter->id == 0)
+    waiter->id = ++last_waiter_id_;
+  auto const id = waiter->id;
+  waiters_.push_back(std::move(waiter));
+  return id;
+}
+
+void client::cancel_waiter(std::uint64_t id)
+{
+  BOOST_ASSERT(strand_.running_in_this_thread());
+  auto it = std::find_if(waiters_.begin(), waiters_.end(), [&](auto const& w) {
+    return w->id == id;
+  });
+  // the request has been handed over to a session in the meantime
+  if (it == waiters_.end())
+    return;
+  auto waiter = std::move(*it);
+  waiters_.erase(it);
+  waiter->cancel();
+}
+
+bool client::make_room(std::size_t endpoint_sessions, std::size_t per_host)
+{
+  if (endpoint_sessions >= per_host)
+    return false;
+  if (sessions_.size() < max_sessions_)
+    return true;
+  if (stopping_)
+    return false;
+  // evict the least recently used idle session
+  auto lru = sessions_.end();
+  auto lru_activity = session_base::clock_type::time_point::max();
+  for (auto it = sessions_.begin(); it != sessions_.end(); ++it)
+  {
+    boost::variant2::visit(
+        [&](auto const& session) {
+          if (session.idle() && session.last_activity() < lru_activity)
+          {
+            lru = it;
+            lru_activity = session.last_activity();
+          }
+        },
+        *it);
+  }
+  if (lru == sessions_.end())
+    return false;
+  retire_session(lru);
+  return true;
+}
+
+void client::retire_session(sessions::iterator it)
+{
+  BOOST_ASSERT(strand_.running_in_this_thread());
+  boost::variant2::visit(
+      [&](auto& session) {
+        using endpoint_type =
+            typename std::decay_t<decltype(session)>::endpoint_type;
+        auto& index = std::get<session_index<endpoint_type>>(index_);
+        auto candidates = index.find(session.endpoint());
+        BOOST_ASSERT(candidates != index.end());
+        auto& lanes = candidates->second;
+        for (auto* adapters :
+             {&lanes.shared.sessions, &lanes.dedicated.sessions})
+          adapters->erase(
+              std::remove(adapters->begin(), adapters->end(), &*it),
+              adapters->end());
+        if (lanes.shared.sessions.empty() && lanes.dedicated.sessions.empty())
+          index.erase(candidates);
+      },
+      *it);
+  retired_.splice(retired_.end(), sessions_, it);
+  boost::variant2::visit(
+      [&](auto& session) {
+        session.async_stop(GracefulShutdown::Yes,
+                           net::bind_executor(strand_, [this, it](error_code) {
+                             retired_.erase(it);
+                             if (retired_.empty())
+                               retired_drained_.cancel();
+                             wake_waiters();
+                           }));
+      },
+      *it);
+}
+
+void client::wake_waiters()
+{
+  BOOST_ASSERT(strand_.running_in_this_thread());
+  // waiters that still cannot be served park themselves again
+  auto waiters = std::exchange(waiters_, {});
+  for (auto& waiter : waiters)
+    waiter->run();
+}
+
+void client::cancel_waiters()
+{
+  BOOST_ASSERT(strand_.running_in_this_thread());
+  auto waiters = std::exchange(waiters_, {});
+  for (auto& waiter : waiters)
+    waiter->cancel();
+}
+
+void client::arm_reaper()
+{
+  BOOST_ASSERT(strand_.running_in_this_thread());
+  if (reaper_armed_ || stopping_ || sessions_.empty() ||
+      idle_timeout_ == std::chrono::nanoseconds::zero())
+    return;
+  reaper_armed_ = true;
+  reaper_.expires_after(idle_timeout_);
+  reaper_.async_wait([this](error_code ec) {
+    // the client may be gone already
+    if (ec == net::error::operation_aborted)
+      return;
+    reaper_armed_ = false;
+    reap_idle_sessions();
+    arm_reaper();
+  });
+}
+
+void client::cancel_reaper()
+{
+  reaper_.cancel();
+  reaper_armed_ = false;
+}
+
+void client::reap_idle_sessions()
+{
+  auto const deadline = session_base::clock_type::now() - idle_timeout_;
+  for (auto it = sessions_.begin(); it != sessions_.end();)
+  {
+    auto current = it++;
+    auto const expired = boost::variant2::visit(
+        [&](auto const& session) {
+          return session.idle() && session.last_activity() <= deadline;
+        },
+        *current);
+    if (expired)
+      retire_session(current);
+  }
+}
+
 void client::add_proxy(http::proxy_match key, http::proxy newproxy)
 {
   net::post(this->strand_, [k = std::move(key), p = std::move(newproxy), this] {
@@ -84,4 +383,29 @@ net::ssl::context& client::context()
   return this->context_;
 }
 
+std::shared_ptr<fetchpp::dns_cache> const& client::get_dns_cache() const
+{
+  return this->dns_cache_;
+}
+
+void client::set_dns_cache(std::shared_ptr<fetchpp::dns_cache> cache)
+{
+  net::post(this->strand_, [c = std::move(cache), this]() mutable {
+    this->dns_cache_ = std::move(c);
+  });
+}
+
+std::shared_ptr<fetchpp::ssl_session_cache> const&
+client::get_ssl_session_cache() const
+{
+  return this->ssl_session_cache_;
+}
+
+void client::set_ssl_session_cache(
+    std::shared_ptr<fetchpp::ssl_session_cache> cache)
+{
+  net::post(this->strand_, [c = std::move(cache), this]() mutable {
+    this->ssl_session_cache_ = std::move(c);
+  });
+}
 }
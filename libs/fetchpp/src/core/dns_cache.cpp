@@ -0,0 +1,152 @@
+#include <fetchpp/core/dns_cache.hpp>
+
+#include <algorithm>
+
+namespace fetchpp
+{
+namespace
+{
+std::string make_key(std::string const& host, std::uint16_t port)
+{
+  return host + ":" + std::to_string(port);
+}
+}
+
+dns_cache::dns_cache(net::any_io_executor ex,
+                     std::chrono::nanoseconds ttl,
+                     std::chrono::nanoseconds negative_ttl,
+                     std::size_t max_entries)
+  : ex_(std::move(ex)),
+    ttl_(ttl),
+    negative_ttl_(negative_ttl),
+    max_entries_(std::max<std::size_t>(max_entries, 1))
+{
+}
+
+std::optional<dns_cache::entry> dns_cache::lookup(std::string const& host,
+                                                  std::uint16_t port)
+{
+  auto const now = clock_type::now();
+  std::unique_lock lock(mutex_);
+  auto it = entries_.find(make_key(host, port));
+  if (it == entries_.end() || it->second.expires_at <= now)
+  {
+    ++misses_;
+    return std::nullopt;
+  }
+  ++hits_;
+  auto& cached = it->second;
+  auto const lifetime = cached.expires_at - cached.stored_at;
+  auto const needs_refresh = !cached.value.ec && !cached.refreshing &&
+                             cached.expires_at - now < lifetime / 4;
+  auto result = cached.value;
+  if (needs_refresh)
+  {
+    cached.refreshing = true;
+    lock.unlock();
+    refresh(host, port);
+  }
+  return result;
+}
+
+void dns_cache::store(std::string const& host,
+                      std::uint16_t port,
+                      error_code ec,
+                      results_type results)
+{
+  auto const now = clock_type::now();
+  auto const lifetime = ec ? negative_ttl_ : ttl_;
+  auto const key = make_key(host, port);
+  std::scoped_lock lock(mutex_);
+  if (entries_.find(key) == entries_.end())
+    evict(now);
+  auto& cached = entries_[key];
+  cached.value = entry{ec, std::move(results)};
+  cached.stored_at = now;
+  cached.expires_at =
+      now + std::chrono::duration_cast<clock_type::duration>(lifetime);
+  cached.refreshing = false;
+}
+
+void dns_cache::evict(clock_type::time_point now)
+{
+  for (auto it = entries_.begin(); it != entries_.end();)
+  {
+    if (it->second.expires_at <= now)
+      it = entries_.erase(it);
+    else
+      ++it;
+  }
+  // room is made for the entry about to be stored
+  while (entries_.size() >= max_entries_)
+  {
+    entries_.erase(std::min_element(
+        entries_.begin(), entries_.end(), [](auto const& a, auto const& b) {
+          return a.second.expires_at < b.second.expires_at;
+        }));
+  }
+}
+
+void dns_cache::clear()
+{
+  std::scoped_lock lock(mutex_);
+  entries_.clear();
+}
+
+void dns_cache::refresh(std::string const& host, std::uint16_t port)
+{
+  // a cache which is not owned by a shared_ptr cannot outlive the request
+  auto self = weak_from_this().lock();
+  if (!self)
+    return;
+  auto resolver = std::make_shared<tcp::resolver>(ex_);
+  resolver->async_resolve(
+      host,
+      std::to_string(port),
+      net::ip::resolver_base::numeric_service,
+      [self, resolver, host, port](error_code ec, results_type results) {
+        // keep serving the current entry when the refresh fails, it expires
+        // normally
+        if (ec)
+        {
+          std::scoped_lock lock(self->mutex_);
+          if (auto it = self->entries_.find(make_key(host, port));
+              it != self->entries_.end())
+            it->second.refreshing = false;
+          return;
+        }
+        self->store(host, port, ec, std::move(results));
+      });
+}
+
+std::chrono::nanoseconds dns_cache::ttl() const
+{
+  return ttl_;
+}
+
+std::chrono::nanoseconds dns_cache::negative_ttl() const
+{
+  return negative_ttl_;
+}
+
+std::size_t dns_cache::max_entries() const
+{
+  return max_entries_;
+}
+
+std::size_t dns_cache::size() const
+{
+  std::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+std::size_t dns_cache::hits() const
+{
+  return hits_;
+}
+
+std::size_t dns_cache::misses() const
+{
+  return misses_;
+}
+}
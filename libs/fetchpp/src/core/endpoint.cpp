@@ -1,5 +1,7 @@
 #include <fetchpp/core/detail/endpoint.hpp>
 
+#include <boost/container_hash/hash.hpp>
+
 namespace fetchpp
 {
 namespace detail
@@ -23,6 +25,14 @@ std::string base_endpoint::host() const
 {
   return domain_ + ":" + std::to_string(port_);
 }
+
+std::size_t hash_value(base_endpoint const& ep)
+{
+  std::size_t seed = 0;
+  boost::hash_combine(seed, ep.domain());
+  boost::hash_combine(seed, ep.port());
+  return seed;
+}
 }
 
 template <bool isSecure>
@@ -75,4 +85,11 @@ bool operator!=(tunnel_endpoint const& left, tunnel_endpoint const& right)
 {
   return !(left == right);
 }
+
+std::size_t hash_value(tunnel_endpoint const& ep)
+{
+  auto seed = std::hash<plain_endpoint>{}(ep.proxy());
+  boost::hash_combine(seed, std::hash<secure_endpoint>{}(ep.target()));
+  return seed;
+}
 }
@@ -1 +1,11 @@
 #include <fetchpp/fetch.hpp>
+
+namespace fetchpp
+{
+net::ssl::context& default_ssl_context()
+{
+  // SSL_CTX is safe to share between threads once configured
+  static net::ssl::context context(net::ssl::context::tls_client);
+  return context;
+}
+}
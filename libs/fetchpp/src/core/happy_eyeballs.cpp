@@ -0,0 +1,33 @@
+#include <fetchpp/core/detail/happy_eyeballs.hpp>
+
+#include <algorithm>
+
+namespace fetchpp::detail
+{
+std::vector<tcp::endpoint> interleave_address_families(
+    tcp::resolver::results_type const& results)
+{
+  std::vector<tcp::endpoint> preferred;
+  std::vector<tcp::endpoint> other;
+  for (auto const& entry : results)
+  {
+    auto const endpoint = entry.endpoint();
+    if (preferred.empty() ||
+        endpoint.address().is_v6() == preferred.front().address().is_v6())
+      preferred.push_back(endpoint);
+    else
+      other.push_back(endpoint);
+  }
+
+  std::vector<tcp::endpoint> interleaved;
+  interleaved.reserve(preferred.size() + other.size());
+  for (std::size_t i = 0; i < std::max(preferred.size(), other.size()); ++i)
+  {
+    if (i < preferred.size())
+      interleaved.push_back(preferred[i]);
+    if (i < other.size())
+      interleaved.push_back(other[i]);
+  }
+  return interleaved;
+}
+}
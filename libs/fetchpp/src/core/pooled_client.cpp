@@ -0,0 +1,52 @@
+#include <fetchpp/pooled_client.hpp>
+
+#include <boost/asio/execution/context.hpp>
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/query.hpp>
+
+#include <memory>
+#include <mutex>
+
+namespace fetchpp
+{
+namespace
+{
+class pooled_client_service : public net::execution_context::service
+{
+public:
+  static net::execution_context::id id;
+
+  explicit pooled_client_service(net::execution_context& context)
+    : net::execution_context::service(context)
+  {
+  }
+
+  client& get(net::any_io_executor ex)
+  {
+    std::scoped_lock lock(mutex_);
+    if (!client_)
+      client_ = std::make_unique<client>(std::move(ex));
+    return *client_;
+  }
+
+private:
+  // sessions own sockets, they must go before the context services do
+  void shutdown() override
+  {
+    std::scoped_lock lock(mutex_);
+    client_.reset();
+  }
+
+  std::mutex mutex_;
+  std::unique_ptr<client> client_;
+};
+
+net::execution_context::id pooled_client_service::id;
+}
+
+client& pooled_client(net::any_io_executor ex)
+{
+  auto& context = net::query(ex, net::execution::context);
+  return net::use_service<pooled_client_service>(context).get(std::move(ex));
+}
+}
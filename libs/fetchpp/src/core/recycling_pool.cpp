@@ -0,0 +1,94 @@
+#include <fetchpp/core/detail/recycling_pool.hpp>
+
+namespace fetchpp::detail
+{
+namespace
+{
+bool recyclable(std::size_t size, std::size_t alignment)
+{
+  return size > 0 && size <= recycling_pool::max_size &&
+         alignment <= alignof(std::max_align_t);
+}
+
+std::size_t size_class(std::size_t size)
+{
+  return (size - 1) / recycling_pool::granularity;
+}
+}
+
+recycling_pool::~recycling_pool()
+{
+  for (std::size_t index = 0; index < class_count; ++index)
+  {
+    while (auto* block = free_[index])
+    {
+      free_[index] = block->next;
+      ::operator delete(block, (index + 1) * granularity);
+    }
+  }
+}
+
+void* recycling_pool::allocate(std::size_t size, std::size_t alignment)
+{
+  if (!recyclable(size, alignment))
+  {
+    {
+      std::scoped_lock lock(mutex_);
+      ++allocations_;
+    }
+    if (alignment > alignof(std::max_align_t))
+      return ::operator new(size, std::align_val_t(alignment));
+    return ::operator new(size);
+  }
+  auto const index = size_class(size);
+  {
+    std::scoped_lock lock(mutex_);
+    if (auto* block = free_[index])
+    {
+      free_[index] = block->next;
+      --cached_[index];
+      ++reuses_;
+      return block;
+    }
+    ++allocations_;
+  }
+  return ::operator new((index + 1) * granularity);
+}
+
+void recycling_pool::deallocate(void* p,
+                                std::size_t size,
+                                std::size_t alignment) noexcept
+{
+  if (!recyclable(size, alignment))
+  {
+    if (alignment > alignof(std::max_align_t))
+      ::operator delete(p, size, std::align_val_t(alignment));
+    else
+      ::operator delete(p, size);
+    return;
+  }
+  auto const index = size_class(size);
+  {
+    std::scoped_lock lock(mutex_);
+    if (cached_[index] < max_cached_per_class)
+    {
+      free_[index] = new (p) free_block{free_[index]};
+      ++cached_[index];
+      return;
+    }
+  }
+  ::operator delete(p, (index + 1) * granularity);
+}
+
+std::size_t recycling_pool::allocations() const
+{
+  std::scoped_lock lock(mutex_);
+  return allocations_;
+}
+
+std::size_t recycling_pool::reuses() const
+{
+  std::scoped_lock lock(mutex_);
+  return reuses_;
+}
+}
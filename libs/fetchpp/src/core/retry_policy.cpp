@@ -0,0 +1,92 @@
+#include <fetchpp/core/retry_policy.hpp>
+
+#include <boost/asio/error.hpp>
+#include <boost/beast/http/error.hpp>
+
+#include <fetchpp/alias/beast.hpp>
+#include <fetchpp/alias/net.hpp>
+
+#include <algorithm>
+
+namespace fetchpp
+{
+failure_kind classify_failure(error_code ec,
+                              bool connecting,
+                              bool reused_connection)
+{
+  if (connecting)
+    return failure_kind::connect;
+  if (ec == beast::error::timeout || ec == net::error::timed_out)
+    return failure_kind::timeout;
+  if (ec == net::error::eof || ec == http::error::end_of_stream ||
+      ec == http::error::partial_message ||
+      ec == net::error::connection_reset ||
+      ec == net::error::connection_aborted || ec == net::error::broken_pipe)
+    return reused_connection ? failure_kind::stale_connection :
+                               failure_kind::connection_lost;
+  return failure_kind::other;
+}
+
+bool is_idempotent(http::verb method)
+{
+  switch (method)
+  {
+  case http::verb::get:
+  case http::verb::head:
+  case http::verb::options:
+  case http::verb::trace:
+  case http::verb::put:
+  case http::verb::delete_:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool retry_policy::retries(failure_kind kind, error_code ec) const
+{
+  if (retry_if)
+    return retry_if(kind, ec);
+  switch (kind)
+  {
+  case failure_kind::connect:
+    return retry_connect;
+  case failure_kind::stale_connection:
+    return retry_stale_connection;
+  case failure_kind::connection_lost:
+    return retry_connection_lost;
+  case failure_kind::timeout:
+    return retry_timeout;
+  default:
+    return false;
+  }
+}
+
+retry_budget::retry_budget(double ratio, std::size_t reserve)
+  : ratio_(ratio),
+    capacity_(static_cast<double>(std::max<std::size_t>(reserve, 1))),
+    balance_(capacity_)
+{
+}
+
+void retry_budget::deposit()
+{
+  std::scoped_lock lock(mutex_);
+  balance_ = std::min(capacity_, balance_ + ratio_);
+}
+
+bool retry_budget::withdraw()
+{
+  std::scoped_lock lock(mutex_);
+  if (balance_ < 1.)
+    return false;
+  balance_ -= 1.;
+  return true;
+}
+
+double retry_budget::balance() const
+{
+  std::scoped_lock lock(mutex_);
+  return balance_;
+}
+}
@@ -1,11 +1,70 @@
 #include <fetchpp/core/detail/session_base.hpp>
 
+#include <boost/assert.hpp>
+
+#include <algorithm>
+
 namespace fetchpp::detail
 {
 task::~task() = default;
 
+void task::deleter::operator()(task* t) const noexcept
+{
+  t->destroy();
+}
+
+void task::destroy() noexcept
+{
+  delete this;
+}
+
+bool task::pipelinable() const
+{
+  return false;
+}
+
+void task::async_write(handler_t)
+{
+  BOOST_ASSERT_MSG(false, "task cannot be pipelined");
+}
+
+void task::async_read(handler_t)
+{
+  BOOST_ASSERT_MSG(false, "task cannot be pipelined");
+}
+
+bool task::keep_alive() const
+{
+  return false;
+}
+
+bool task::cancelled() const
+{
+  return false;
+}
+
+std::optional<std::chrono::nanoseconds> task::next_retry_delay(error_code)
+{
+  return std::nullopt;
+}
+
+void task::abort()
+{
+}
+
+void task::complete(error_code)
+{
+  BOOST_ASSERT_MSG(false, "task cannot be completed by the session");
+}
+
 session_base::session_base(net::any_io_executor default_ex)
-  : strand_(default_ex), timer_(strand_)
+  : strand_(default_ex),
+    timer_(strand_),
+    retry_timer_(strand_),
+    pool_(std::make_shared<recycling_pool>()),
+    retry_budget_(std::make_shared<retry_budget>(
+        retry_policy_.budget_ratio, retry_policy_.budget_reserve)),
+    random_(std::random_device{}())
 {
 }
 
@@ -34,23 +93,94 @@ bool session_base::running() const
   return is_running_;
 }
 
-void session_base::push_task(detail::task::ptr_t t)
+std::uint64_t session_base::push_task(
+    detail::task::ptr_t t, std::optional<clock_type::time_point> deadline)
 {
-  tasks_.push(std::move(t));
+  last_activity_ = clock_type::now();
+  t->id = ++last_task_id_;
+  t->queued_at = last_activity_;
+  if (deadline)
+  {
+    t->expiry.emplace(strand_, *deadline);
+    t->expiry->async_wait([this, id = t->id](error_code ec) {
+      if (!ec)
+        expire_task(id);
+    });
+  }
+  tasks_.push_back(std::move(t));
+  count_request();
+  return last_task_id_;
 }
 
 void session_base::process_task()
 {
   BOOST_ASSERT(get_internal_executor().running_in_this_thread());
-  if (has_tasks())
+  if (has_tasks() && !tasks_.front()->started)
+  {
+    schedule_tasks();
+    tasks_.front()->started = true;
     tasks_.front()->run();
+  }
+}
+
+void session_base::schedule_tasks()
+{
+  // tasks only start from the front, nothing has started yet
+  if (tasks_.size() < 2)
+    return;
+  auto const now = clock_type::now();
+  auto const effective = [&](task const& t) -> std::int64_t {
+    if (priority_aging_.count() <= 0)
+      return t.priority;
+    return t.priority + (now - t.queued_at) / priority_aging_;
+  };
+  std::stable_sort(
+      tasks_.begin(), tasks_.end(), [&](auto const& lhs, auto const& rhs) {
+        return effective(*lhs) > effective(*rhs);
+      });
+}
+
+void session_base::expire_task(std::uint64_t id)
+{
+  auto it = std::find_if(tasks_.begin(), tasks_.end(), [&](auto const& t) {
+    return t->id == id;
+  });
+  // the transport deadline takes over once the task has started
+  if (it == tasks_.end() || (*it)->started)
+    return;
+  auto expired = std::move(*it);
+  tasks_.erase(it);
+  expired->complete(beast::error::timeout);
+  if (this->idle() && this->on_idle_)
+    this->on_idle_();
+}
+
+void session_base::cancel_task(std::uint64_t id)
+{
+  BOOST_ASSERT(get_internal_executor().running_in_this_thread());
+  auto it = std::find_if(tasks_.begin(), tasks_.end(), [&](auto const& t) {
+    return t->id == id;
+  });
+  if (it == tasks_.end())
+    return;
+  if ((*it)->started)
+  {
+    (*it)->abort();
+    return;
+  }
+  auto cancelled = std::move(*it);
+  tasks_.erase(it);
+  cancelled->cancel();
+  if (this->idle() && this->on_idle_)
+    this->on_idle_();
 }
 
 void session_base::pop_task()
 {
   BOOST_ASSERT(get_internal_executor().running_in_this_thread());
   BOOST_ASSERT(has_tasks());
-  tasks_.pop();
+  last_activity_ = clock_type::now();
+  tasks_.pop_front();
 }
 
 void session_base::cancel_all_tasks()
@@ -71,11 +201,179 @@ void session_base::advance_task()
     this->process_task();
   else
     this->cancel_all_tasks();
+  if (this->idle() && this->on_idle_)
+    this->on_idle_();
+}
+
+task& session_base::front_task()
+{
+  BOOST_ASSERT(has_tasks());
+  return *tasks_.front();
+}
+
+task& session_base::task_at(std::size_t index)
+{
+  BOOST_ASSERT(index < tasks_.size());
+  return *tasks_[index];
+}
+
+std::size_t session_base::pipeline_depth() const
+{
+  return pipeline_depth_;
+}
+
+void session_base::set_pipeline_depth(std::size_t depth)
+{
+  pipeline_depth_ = std::max<std::size_t>(depth, 1);
+}
+
+void session_base::disable_pipelining()
+{
+  pipeline_depth_ = 1;
+}
+
+std::size_t session_base::pipeline_batch() const
+{
+  if (pipeline_depth_ <= 1)
+    return 0;
+  auto const end = tasks_.begin() + std::min(pipeline_depth_, tasks_.size());
+  auto const last = std::find_if(
+      tasks_.begin(), end, [](auto const& t) { return !t->pipelinable(); });
+  return static_cast<std::size_t>(last - tasks_.begin());
+}
+
+void session_base::restart_tasks(std::size_t count)
+{
+  BOOST_ASSERT(count <= tasks_.size());
+  for (std::size_t i = 0; i < count; ++i)
+    tasks_[i]->started = false;
+}
+
+std::chrono::nanoseconds session_base::priority_aging() const
+{
+  return priority_aging_;
+}
+
+void session_base::set_priority_aging(std::chrono::nanoseconds period)
+{
+  priority_aging_ = period;
+}
+
+void session_base::reserve()
+{
+  ++reserved_;
+  last_activity_ = clock_type::now();
+}
+
+void session_base::release()
+{
+  if (reserved_ > 0)
+    --reserved_;
+}
+
+std::size_t session_base::reserved() const
+{
+  return reserved_;
+}
+
+bool session_base::idle() const
+{
+  return !has_tasks() && reserved_ == 0;
+}
+
+auto session_base::last_activity() const -> clock_type::time_point
+{
+  return last_activity_;
+}
+
+void session_base::on_idle(std::function<void()> callback)
+{
+  on_idle_ = std::move(callback);
+}
+
+fetchpp::retry_policy const& session_base::get_retry_policy() const
+{
+  return retry_policy_;
+}
+
+void session_base::set_retry_policy(fetchpp::retry_policy policy,
+                                    std::shared_ptr<retry_budget> budget)
+{
+  if (!budget)
+    budget = std::make_shared<retry_budget>(policy.budget_ratio,
+                                            policy.budget_reserve);
+  retry_policy_ = std::move(policy);
+  retry_budget_ = std::move(budget);
+}
+
+void session_base::count_request()
+{
+  retry_budget_->deposit();
+}
+
+std::optional<std::chrono::nanoseconds> session_base::retry_delay(
+    failure_kind kind, error_code ec, std::size_t attempt, bool idempotent)
+{
+  if (attempt >= retry_policy_.max_attempts ||
+      !retry_policy_.retries(kind, ec))
+    return std::nullopt;
+  if (!idempotent && !retry_policy_.retry_non_idempotent &&
+      kind != failure_kind::connect)
+    return std::nullopt;
+  if (!retry_budget_->withdraw())
+    return std::nullopt;
+  ++retries_;
+  if (kind == failure_kind::stale_connection)
+    return std::chrono::nanoseconds::zero();
+
+  // full jitter: a random delay up to the exponential backoff
+  auto backoff = retry_policy_.base_backoff;
+  for (std::size_t i = 1; i < attempt && backoff < retry_policy_.max_backoff;
+       ++i)
+    backoff *= 2;
+  backoff = std::min(backoff, retry_policy_.max_backoff);
+  if (backoff.count() <= 0)
+    return std::chrono::nanoseconds::zero();
+  std::uniform_int_distribution<std::chrono::nanoseconds::rep> pick(
+      0, backoff.count());
+  return std::chrono::nanoseconds(pick(random_));
+}
+
+std::size_t session_base::retries() const
+{
+  return retries_;
+}
+
+void session_base::cancel_retry()
+{
+  retry_timer_.cancel();
+}
+
+std::shared_ptr<recycling_pool> const& session_base::memory_pool() const
+{
+  return pool_;
+}
+
+std::size_t session_base::allocations() const
+{
+  return pool_->allocations();
 }
 
 void session_base::set_running(bool new_state)
 {
   is_running_ = new_state;
+  is_failed_ = false;
+}
+
+void session_base::set_failed()
+{
+  is_running_ = false;
+  is_failed_ = true;
+}
+
+bool session_base::failed() const
+{
+  return is_failed_;
 }
 
 }
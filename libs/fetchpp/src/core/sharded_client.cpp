@@ -0,0 +1,155 @@
+#include <fetchpp/sharded_client.hpp>
+
+#include <fetchpp/core/detail/endpoint.hpp>
+
+#include <boost/container_hash/hash.hpp>
+
+#include <numeric>
+#include <stdexcept>
+
+namespace fetchpp
+{
+sharded_client::sharded_client(net::any_io_executor ex,
+                               std::size_t shards,
+                               std::chrono::nanoseconds timeout)
+  : sharded_client(ex, shards, timeout, [] {
+      return net::ssl::context(net::ssl::context::tlsv12_client);
+    })
+{
+}
+
+sharded_client::sharded_client(net::io_context& ioc,
+                               std::size_t shards,
+                               std::chrono::nanoseconds timeout)
+  : sharded_client(ioc.get_executor(), shards, timeout)
+{
+}
+
+sharded_client::sharded_client(net::any_io_executor ex,
+                               std::size_t shards,
+                               std::chrono::nanoseconds timeout,
+                               context_factory make_context)
+  : ex_(ex)
+{
+  if (shards == 0)
+    throw std::invalid_argument("a sharded client needs at least one shard");
+  shards_.reserve(shards);
+  for (std::size_t i = 0; i < shards; ++i)
+    shards_.push_back(std::make_unique<client>(ex, timeout, make_context()));
+  // resolutions are shared, an endpoint always lands on the same shard but
+  // several endpoints usually share a domain. TLS sessions stay with the
+  // context of their shard
+  auto dns = shards_.front()->get_dns_cache();
+  for (auto& s : shards_)
+    s->set_dns_cache(dns);
+}
+
+std::size_t sharded_client::shard_count() const
+{
+  return shards_.size();
+}
+
+client& sharded_client::shard(std::size_t index)
+{
+  return *shards_.at(index);
+}
+
+client const& sharded_client::shard(std::size_t index) const
+{
+  return *shards_.at(index);
+}
+
+client& sharded_client::shard_for(http::url const& uri)
+{
+  auto const secure = http::is_ssl_involved(uri);
+  auto seed = detail::hash_value(detail::to_endpoint<false>(uri));
+  boost::hash_combine(seed, secure);
+  return *shards_[seed % shards_.size()];
+}
+
+std::size_t sharded_client::session_count() const
+{
+  return std::accumulate(
+      shards_.begin(), shards_.end(), std::size_t{0}, [](auto sum, auto& s) {
+        return sum + s->session_count();
+      });
+}
+
+void sharded_client::set_max_pending_per_session(std::size_t pending)
+{
+  for (auto& s : shards_)
+    s->set_max_pending_per_session(pending);
+}
+
+void sharded_client::set_max_sessions(std::size_t max)
+{
+  for (auto& s : shards_)
+    s->set_max_sessions(max);
+}
+
+void sharded_client::set_max_sessions_per_host(std::size_t max)
+{
+  for (auto& s : shards_)
+    s->set_max_sessions_per_host(max);
+}
+
+void sharded_client::set_idle_timeout(std::chrono::nanoseconds timeout)
+{
+  for (auto& s : shards_)
+    s->set_idle_timeout(timeout);
+}
+
+void sharded_client::set_session_selection(session_selection policy)
+{
+  for (auto& s : shards_)
+    s->set_session_selection(policy);
+}
+
+void sharded_client::set_pipeline_depth(std::size_t depth)
+{
+  for (auto& s : shards_)
+    s->set_pipeline_depth(depth);
+}
+
+void sharded_client::set_retry_policy(retry_policy const& policy)
+{
+  for (auto& s : shards_)
+    s->set_retry_policy(policy);
+}
+
+void sharded_client::set_priority_threshold(std::optional<int> threshold)
+{
+  for (auto& s : shards_)
+    s->set_priority_threshold(threshold);
+}
+
+void sharded_client::set_priority_sessions_per_host(std::size_t max)
+{
+  for (auto& s : shards_)
+    s->set_priority_sessions_per_host(max);
+}
+
+void sharded_client::set_priority_aging(std::chrono::nanoseconds period)
+{
+  for (auto& s : shards_)
+    s->set_priority_aging(period);
+}
+
+void sharded_client::set_verify_peer(bool v)
+{
+  for (auto& s : shards_)
+    s->set_verify_peer(v);
+}
+
+void sharded_client::add_proxy(http::proxy_match key, http::proxy newproxy)
+{
+  for (auto& s : shards_)
+    s->add_proxy(key, newproxy);
+}
+
+void sharded_client::set_proxies(http::proxy_map newproxies)
+{
+  for (auto& s : shards_)
+    s->set_proxies(newproxies);
+}
+}
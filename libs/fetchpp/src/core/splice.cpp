@@ -0,0 +1,151 @@
+#include <fetchpp/core/detail/splice.hpp>
+
+#include <boost/asio/error.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <fetchpp/alias/net.hpp>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+namespace fetchpp::detail
+{
+namespace
+{
+error_code last_error()
+{
+  return error_code(errno, boost::system::system_category());
+}
+}
+
+bool can_send_file(int fd)
+{
+#if defined(__linux__)
+  struct stat status;
+  return ::fstat(fd, &status) == 0 && S_ISREG(status.st_mode);
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
+std::size_t send_file(int socket,
+                      int fd,
+                      std::uint64_t& offset,
+                      std::size_t size,
+                      error_code& ec)
+{
+  ec = {};
+#if defined(__linux__)
+  auto position = static_cast<off_t>(offset);
+  ssize_t sent;
+  do
+  {
+    sent = ::sendfile(socket, fd, &position, size);
+  } while (sent < 0 && errno == EINTR);
+  if (sent < 0)
+  {
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      ec = net::error::would_block;
+    else
+      ec = last_error();
+    return 0;
+  }
+  offset = static_cast<std::uint64_t>(position);
+  return static_cast<std::size_t>(sent);
+#else
+  (void)socket;
+  (void)fd;
+  (void)offset;
+  (void)size;
+  ec = net::error::operation_not_supported;
+  return 0;
+#endif
+}
+
+bool can_splice_to(int fd)
+{
+#if defined(__linux__)
+  struct stat status;
+  if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+    return false;
+  auto const flags = ::fcntl(fd, F_GETFL);
+  return flags >= 0 && (flags & O_APPEND) == 0;
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
+socket_splicer::~socket_splicer()
+{
+  for (auto fd : pipe_)
+  {
+    if (fd >= 0)
+      ::close(fd);
+  }
+}
+
+std::size_t socket_splicer::transfer(int socket,
+                                     int fd,
+                                     std::size_t size,
+                                     error_code& ec)
+{
+  ec = {};
+#if defined(__linux__)
+  if (pipe_[0] < 0 && ::pipe2(pipe_.data(), O_CLOEXEC) != 0)
+  {
+    ec = last_error();
+    return 0;
+  }
+  // the socket is non blocking, as asio leaves it
+  ssize_t moved;
+  do
+  {
+    moved = ::splice(socket,
+                     nullptr,
+                     pipe_[1],
+                     nullptr,
+                     std::min(size, chunk_size),
+                     SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  } while (moved < 0 && errno == EINTR);
+  if (moved < 0)
+  {
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      ec = net::error::would_block;
+    else
+      ec = last_error();
+    return 0;
+  }
+  auto left = static_cast<std::size_t>(moved);
+  while (left > 0)
+  {
+    auto const written =
+        ::splice(pipe_[0], nullptr, fd, nullptr, left, SPLICE_F_MOVE);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      ec = last_error();
+      return static_cast<std::size_t>(moved) - left;
+    }
+    left -= static_cast<std::size_t>(written);
+  }
+  return static_cast<std::size_t>(moved);
+#else
+  (void)socket;
+  (void)fd;
+  (void)size;
+  ec = net::error::operation_not_supported;
+  return 0;
+#endif
+}
+}
@@ -0,0 +1,156 @@
+#include <fetchpp/core/ssl_session_cache.hpp>
+
+namespace fetchpp
+{
+namespace
+{
+// attached to each SSL prepared by a cache, it tells on_new_session where
+// the sessions go
+struct binding
+{
+  std::weak_ptr<ssl_session_cache> cache;
+  std::string key;
+};
+
+void free_binding(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*)
+{
+  delete static_cast<binding*>(ptr);
+}
+
+int binding_index()
+{
+  static int const index =
+      SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &free_binding);
+  return index;
+}
+
+void free_context_id(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*)
+{
+  delete static_cast<std::uint64_t*>(ptr);
+}
+
+int context_id_index()
+{
+  static int const index = SSL_CTX_get_ex_new_index(
+      0, nullptr, nullptr, nullptr, &free_context_id);
+  return index;
+}
+
+std::uint64_t context_id(SSL_CTX* ctx)
+{
+  auto const id =
+      static_cast<std::uint64_t*>(SSL_CTX_get_ex_data(ctx, context_id_index()));
+  return id ? *id : 0;
+}
+
+// a session is only offered to the context it was negotiated with, and only
+// with the verification it was negotiated under
+std::string make_key(SSL* ssl, std::string const& host, std::uint16_t port)
+{
+  return host + ":" + std::to_string(port) + "#" +
+         std::to_string(context_id(SSL_get_SSL_CTX(ssl))) + "/" +
+         std::to_string(SSL_get_verify_mode(ssl));
+}
+}
+
+ssl_session_cache::ssl_session_cache(std::size_t capacity)
+  : capacity_(capacity)
+{
+}
+
+ssl_session_cache::~ssl_session_cache()
+{
+  for (auto& [key, session] : sessions_)
+    SSL_SESSION_free(session);
+}
+
+void ssl_session_cache::attach(net::ssl::context& context)
+{
+  static std::atomic<std::uint64_t> next_id{0};
+  auto const ctx = context.native_handle();
+  if (!SSL_CTX_get_ex_data(ctx, context_id_index()))
+    SSL_CTX_set_ex_data(ctx, context_id_index(), new std::uint64_t{++next_id});
+  SSL_CTX_set_session_cache_mode(
+      context.native_handle(),
+      SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(context.native_handle(),
+                          &ssl_session_cache::on_new_session);
+}
+
+void ssl_session_cache::prepare(SSL* ssl,
+                                std::string const& host,
+                                std::uint16_t port)
+{
+  auto key = make_key(ssl, host, port);
+  {
+    std::scoped_lock lock(mutex_);
+    if (auto it = sessions_.find(key); it != sessions_.end())
+      SSL_set_session(ssl, it->second);
+  }
+  delete static_cast<binding*>(SSL_get_ex_data(ssl, binding_index()));
+  SSL_set_ex_data(
+      ssl, binding_index(), new binding{weak_from_this(), std::move(key)});
+}
+
+void ssl_session_cache::handshake_done(SSL* ssl)
+{
+  ++handshakes_;
+  if (SSL_session_reused(ssl))
+    ++resumptions_;
+}
+
+void ssl_session_cache::clear()
+{
+  std::scoped_lock lock(mutex_);
+  for (auto& [key, session] : sessions_)
+    SSL_SESSION_free(session);
+  sessions_.clear();
+}
+
+std::size_t ssl_session_cache::size() const
+{
+  std::scoped_lock lock(mutex_);
+  return sessions_.size();
+}
+
+std::size_t ssl_session_cache::handshakes() const
+{
+  return handshakes_;
+}
+
+std::size_t ssl_session_cache::resumptions() const
+{
+  return resumptions_;
+}
+
+int ssl_session_cache::on_new_session(SSL* ssl, SSL_SESSION* session)
+{
+  auto const b = static_cast<binding*>(SSL_get_ex_data(ssl, binding_index()));
+  if (!b)
+    return 0;
+  auto cache = b->cache.lock();
+  if (!cache)
+    return 0;
+  // returning 1 hands the reference over to the cache
+  cache->store(b->key, session);
+  return 1;
+}
+
+void ssl_session_cache::store(std::string const& key, SSL_SESSION* session)
+{
+  std::scoped_lock lock(mutex_);
+  auto it = sessions_.find(key);
+  if (it != sessions_.end())
+  {
+    SSL_SESSION_free(it->second);
+    it->second = session;
+    return;
+  }
+  if (sessions_.size() >= capacity_ && !sessions_.empty())
+  {
+    SSL_SESSION_free(sessions_.begin()->second);
+    sessions_.erase(sessions_.begin());
+  }
+  sessions_.emplace(key, session);
+}
+}
@@ -0,0 +1,224 @@
+#include <fetchpp/http/detail/content_coding.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/beast/zlib/error.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#include <zlib.h>
+
+namespace fetchpp::http::detail
+{
+namespace
+{
+error_code to_error_code(int result)
+{
+  switch (result)
+  {
+  case Z_MEM_ERROR:
+    return boost::system::errc::make_error_code(
+        boost::system::errc::not_enough_memory);
+  case Z_NEED_DICT:
+    return beast::zlib::error::need_dict;
+  case Z_STREAM_ERROR:
+    return beast::zlib::error::stream_error;
+  default:
+    return beast::zlib::error::general;
+  }
+}
+
+uInt clamp(std::size_t size)
+{
+  return static_cast<uInt>(
+      std::min<std::size_t>(size, std::numeric_limits<uInt>::max()));
+}
+
+string_view trim(string_view value)
+{
+  auto const is_space = [](char c) { return c == ' ' || c == '\t'; };
+  while (!value.empty() && is_space(value.front()))
+    value.remove_prefix(1);
+  while (!value.empty() && is_space(value.back()))
+    value.remove_suffix(1);
+  return value;
+}
+
+bool starts_gzip_member(net::const_buffer input)
+{
+  auto const* data = static_cast<unsigned char const*>(input.data());
+  return input.size() >= 2 && data[0] == 0x1f && data[1] == 0x8b;
+}
+}
+
+std::optional<content_coding> parse_content_coding(string_view value)
+{
+  auto const coding = trim(value);
+  if (coding.empty() || boost::algorithm::iequals(coding, "identity"))
+    return content_coding::identity;
+  if (boost::algorithm::iequals(coding, "gzip") ||
+      boost::algorithm::iequals(coding, "x-gzip"))
+    return content_coding::gzip;
+  if (boost::algorithm::iequals(coding, "deflate"))
+    return content_coding::deflate;
+  return std::nullopt;
+}
+
+struct content_decoder::stream
+{
+  z_stream z = {};
+  bool initialized = false;
+};
+
+content_decoder::content_decoder(content_coding coding)
+  : stream_(std::make_unique<stream>()), coding_(coding)
+{
+}
+
+content_decoder::~content_decoder()
+{
+  if (stream_->initialized)
+    ::inflateEnd(&stream_->z);
+}
+
+bool content_decoder::done() const
+{
+  return done_;
+}
+
+std::pair<std::size_t, std::size_t> content_decoder::decode(
+    net::const_buffer input, net::mutable_buffer output, error_code& ec)
+{
+  ec = {};
+  auto& z = stream_->z;
+  if (done_)
+  {
+    // gzip bodies may be made of several members
+    if (coding_ != content_coding::gzip || !starts_gzip_member(input))
+      return {input.size(), 0};
+    ::inflateReset(&z);
+    done_ = false;
+  }
+  if (!stream_->initialized)
+  {
+    auto const window_bits = coding_ == content_coding::gzip ? 16 + MAX_WBITS :
+                             raw_                            ? -MAX_WBITS :
+                                                               MAX_WBITS;
+    if (auto const result = ::inflateInit2(&z, window_bits); result != Z_OK)
+    {
+      ec = to_error_code(result);
+      return {0, 0};
+    }
+    stream_->initialized = true;
+  }
+
+  auto const fresh = z.total_in == 0;
+  auto const available_in = clamp(input.size());
+  auto const available_out = clamp(output.size());
+  z.next_in = static_cast<Bytef*>(const_cast<void*>(input.data()));
+  z.avail_in = available_in;
+  z.next_out = static_cast<Bytef*>(output.data());
+  z.avail_out = available_out;
+  auto const result = ::inflate(&z, Z_NO_FLUSH);
+  auto const consumed = std::size_t{available_in - z.avail_in};
+  auto const produced = std::size_t{available_out - z.avail_out};
+
+  switch (result)
+  {
+  case Z_OK:
+  case Z_BUF_ERROR:
+    break;
+  case Z_STREAM_END:
+    done_ = true;
+    break;
+  case Z_DATA_ERROR:
+    if (coding_ == content_coding::deflate && !raw_ && fresh)
+    {
+      ::inflateEnd(&z);
+      z = {};
+      stream_->initialized = false;
+      raw_ = true;
+      return decode(input, output, ec);
+    }
+    [[fallthrough]];
+  default:
+    ec = to_error_code(result);
+  }
+  return {consumed, produced};
+}
+
+struct content_encoder::stream
+{
+  z_stream z = {};
+  bool initialized = false;
+};
+
+content_encoder::content_encoder() : stream_(std::make_unique<stream>())
+{
+}
+
+content_encoder::~content_encoder()
+{
+  if (stream_->initialized)
+    ::deflateEnd(&stream_->z);
+}
+
+bool content_encoder::done() const
+{
+  return done_;
+}
+
+std::pair<std::size_t, std::size_t> content_encoder::encode(
+    net::const_buffer input,
+    net::mutable_buffer output,
+    bool last,
+    error_code& ec)
+{
+  ec = {};
+  if (done_)
+    return {0, 0};
+  auto& z = stream_->z;
+  if (!stream_->initialized)
+  {
+    auto const result = ::deflateInit2(&z,
+                                       Z_DEFAULT_COMPRESSION,
+                                       Z_DEFLATED,
+                                       16 + MAX_WBITS,
+                                       8,
+                                       Z_DEFAULT_STRATEGY);
+    if (result != Z_OK)
+    {
+      ec = to_error_code(result);
+      return {0, 0};
+    }
+    stream_->initialized = true;
+  }
+
+  auto const available_in = clamp(input.size());
+  auto const available_out = clamp(output.size());
+  z.next_in = static_cast<Bytef*>(const_cast<void*>(input.data()));
+  z.avail_in = available_in;
+  z.next_out = static_cast<Bytef*>(output.data());
+  z.avail_out = available_out;
+  // only the last call may finish the stream, with all the input left
+  auto const flush =
+      last && available_in == input.size() ? Z_FINISH : Z_NO_FLUSH;
+  auto const result = ::deflate(&z, flush);
+  auto const consumed = std::size_t{available_in - z.avail_in};
+  auto const produced = std::size_t{available_out - z.avail_out};
+
+  switch (result)
+  {
+  case Z_OK:
+  case Z_BUF_ERROR:
+    break;
+  case Z_STREAM_END:
+    done_ = true;
+    break;
+  default:
+    ec = to_error_code(result);
+  }
+  return {consumed, produced};
+}
+}
@@ -0,0 +1,586 @@
+#include <fetchpp/http/detail/json_parser.hpp>
+
+#include <boost/system/error_code.hpp>
+
+#include <charconv>
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+
+namespace fetchpp::http::detail
+{
+namespace
+{
+constexpr auto unknown_size = std::numeric_limits<std::size_t>::max();
+
+error_code bad_message()
+{
+  return boost::system::errc::make_error_code(
+      boost::system::errc::bad_message);
+}
+
+bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool is_digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+bool is_number_char(char c)
+{
+  return is_digit(c) || c == '-' || c == '+' || c == '.' || c == 'e' ||
+         c == 'E';
+}
+
+int hex_value(char c)
+{
+  if (is_digit(c))
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool is_valid_number(std::string const& token)
+{
+  std::size_t i = 0;
+  auto const digits = [&] {
+    auto const start = i;
+    while (i < token.size() && is_digit(token[i]))
+      ++i;
+    return i > start;
+  };
+  if (i < token.size() && token[i] == '-')
+    ++i;
+  if (i < token.size() && token[i] == '0')
+    ++i;
+  else if (!digits())
+    return false;
+  if (i < token.size() && token[i] == '.')
+  {
+    ++i;
+    if (!digits())
+      return false;
+  }
+  if (i < token.size() && (token[i] == 'e' || token[i] == 'E'))
+  {
+    ++i;
+    if (i < token.size() && (token[i] == '+' || token[i] == '-'))
+      ++i;
+    if (!digits())
+      return false;
+  }
+  return i == token.size();
+}
+
+void append_utf8(std::string& out, std::uint32_t code_point)
+{
+  if (code_point < 0x80)
+    out += static_cast<char>(code_point);
+  else if (code_point < 0x800)
+  {
+    out += static_cast<char>(0xC0 | (code_point >> 6));
+    out += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+  else if (code_point < 0x10000)
+  {
+    out += static_cast<char>(0xE0 | (code_point >> 12));
+    out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+  else
+  {
+    out += static_cast<char>(0xF0 | (code_point >> 18));
+    out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+}
+}
+
+json_builder::json_builder(nlohmann::json& root) : root_(root)
+{
+}
+
+template <typename Value>
+nlohmann::json* json_builder::add(Value&& value)
+{
+  if (containers_.empty())
+  {
+    root_ = nlohmann::json(std::forward<Value>(value));
+    return &root_;
+  }
+  auto& container = *containers_.back();
+  if (container.is_array())
+  {
+    container.push_back(nlohmann::json(std::forward<Value>(value)));
+    return &container.back();
+  }
+  *member_ = nlohmann::json(std::forward<Value>(value));
+  return member_;
+}
+
+bool json_builder::null()
+{
+  add(nullptr);
+  return true;
+}
+
+bool json_builder::boolean(bool val)
+{
+  add(val);
+  return true;
+}
+
+bool json_builder::number_integer(number_integer_t val)
+{
+  add(val);
+  return true;
+}
+
+bool json_builder::number_unsigned(number_unsigned_t val)
+{
+  add(val);
+  return true;
+}
+
+bool json_builder::number_float(number_float_t val, string_t const&)
+{
+  add(val);
+  return true;
+}
+
+bool json_builder::string(string_t& val)
+{
+  add(std::move(val));
+  return true;
+}
+
+bool json_builder::binary(binary_t& val)
+{
+  add(nlohmann::json::binary(std::move(val)));
+  return true;
+}
+
+bool json_builder::start_object(std::size_t)
+{
+  containers_.push_back(add(nlohmann::json::value_t::object));
+  return true;
+}
+
+bool json_builder::key(string_t& val)
+{
+  member_ = &(*containers_.back())[val];
+  return true;
+}
+
+bool json_builder::end_object()
+{
+  containers_.pop_back();
+  return true;
+}
+
+bool json_builder::start_array(std::size_t)
+{
+  containers_.push_back(add(nlohmann::json::value_t::array));
+  return true;
+}
+
+bool json_builder::end_array()
+{
+  containers_.pop_back();
+  return true;
+}
+
+bool json_builder::parse_error(std::size_t,
+                               std::string const&,
+                               nlohmann::detail::exception const&)
+{
+  return false;
+}
+
+json_push_parser::json_push_parser(json_sax& sax) : sax_(sax)
+{
+}
+
+bool json_push_parser::stopped() const
+{
+  return stopped_;
+}
+
+void json_push_parser::write(string_view input, error_code& ec)
+{
+  ec = {};
+  for (auto c : input)
+  {
+    if (stopped_)
+      break;
+    step(c, ec);
+    if (ec)
+      break;
+  }
+}
+
+void json_push_parser::finish(error_code& ec)
+{
+  ec = {};
+  if (stopped_ || !started_)
+    return;
+  // nothing tells where a top level number ends
+  if (state_ == state::number && containers_.empty())
+    end_number(ec);
+  if (!ec && !stopped_ && state_ != state::end)
+    ec = bad_message();
+}
+
+void json_push_parser::emit(bool keep_going)
+{
+  if (!keep_going)
+    stopped_ = true;
+}
+
+void json_push_parser::value_done()
+{
+  state_ = containers_.empty() ? state::end : state::next;
+}
+
+void json_push_parser::step(char c, error_code& ec)
+{
+  switch (state_)
+  {
+  case state::string:
+    return string_char(c, ec);
+  case state::escape:
+    return escape_char(c, ec);
+  case state::unicode:
+    return unicode_char(c, ec);
+  case state::literal:
+    if (c != literal_[token_.size()])
+    {
+      ec = bad_message();
+      return;
+    }
+    token_ += c;
+    if (token_.size() < literal_size_)
+      return;
+    if (literal_[0] == 'n')
+      emit(sax_.null());
+    else
+      emit(sax_.boolean(literal_[0] == 't'));
+    return value_done();
+  case state::number:
+    if (is_number_char(c))
+    {
+      token_ += c;
+      return;
+    }
+    end_number(ec);
+    if (ec || stopped_)
+      return;
+    // the character following the number is parsed in the next state
+    break;
+  default:
+    break;
+  }
+
+  if (is_space(c))
+    return;
+  started_ = true;
+  switch (state_)
+  {
+  case state::first_value:
+    if (c == ']')
+      return end_container(false, ec);
+    [[fallthrough]];
+  case state::value:
+    return start_value(c, ec);
+  case state::first_key:
+    if (c == '}')
+      return end_container(true, ec);
+    [[fallthrough]];
+  case state::key:
+    if (c != '"')
+    {
+      ec = bad_message();
+      return;
+    }
+    token_.clear();
+    key_ = true;
+    state_ = state::string;
+    return;
+  case state::colon:
+    if (c != ':')
+    {
+      ec = bad_message();
+      return;
+    }
+    state_ = state::value;
+    return;
+  case state::next:
+    if (c == ',')
+      state_ = containers_.back() ? state::key : state::value;
+    else if (c == '}' || c == ']')
+      end_container(c == '}', ec);
+    else
+      ec = bad_message();
+    return;
+  default:
+    ec = bad_message();
+    return;
+  }
+}
+
+void json_push_parser::start_value(char c, error_code& ec)
+{
+  token_.clear();
+  switch (c)
+  {
+  case '{':
+    containers_.push_back(true);
+    state_ = state::first_key;
+    return emit(sax_.start_object(unknown_size));
+  case '[':
+    containers_.push_back(false);
+    state_ = state::first_value;
+    return emit(sax_.start_array(unknown_size));
+  case '"':
+    key_ = false;
+    state_ = state::string;
+    return;
+  case 't':
+    literal_ = "true";
+    break;
+  case 'f':
+    literal_ = "false";
+    break;
+  case 'n':
+    literal_ = "null";
+    break;
+  default:
+    if (c != '-' && !is_digit(c))
+    {
+      ec = bad_message();
+      return;
+    }
+    token_ += c;
+    state_ = state::number;
+    return;
+  }
+  literal_size_ = std::char_traits<char>::length(literal_);
+  token_ += c;
+  state_ = state::literal;
+}
+
+void json_push_parser::string_char(char c, error_code& ec)
+{
+  auto const byte = static_cast<unsigned char>(c);
+  // a \u escape of a high surrogate is followed by the one of the low
+  // surrogate
+  if (high_surrogate_ && c != '\\')
+  {
+    ec = bad_message();
+    return;
+  }
+  if (utf8_pending_)
+  {
+    if (byte < utf8_low_ || byte > utf8_high_)
+    {
+      ec = bad_message();
+      return;
+    }
+    utf8_low_ = 0x80;
+    utf8_high_ = 0xBF;
+    --utf8_pending_;
+  }
+  else if (c == '"')
+    return end_string();
+  else if (c == '\\')
+  {
+    state_ = state::escape;
+    return;
+  }
+  else if (byte < 0x20)
+  {
+    ec = bad_message();
+    return;
+  }
+  else if (byte >= 0x80)
+  {
+    if (byte >= 0xC2 && byte <= 0xDF)
+      utf8_pending_ = 1;
+    else if (byte >= 0xE0 && byte <= 0xEF)
+      utf8_pending_ = 2;
+    else if (byte >= 0xF0 && byte <= 0xF4)
+      utf8_pending_ = 3;
+    else
+    {
+      ec = bad_message();
+      return;
+    }
+    // rules out overlong forms, surrogates and code points past U+10FFFF
+    if (byte == 0xE0)
+      utf8_low_ = 0xA0;
+    else if (byte == 0xED)
+      utf8_high_ = 0x9F;
+    else if (byte == 0xF0)
+      utf8_low_ = 0x90;
+    else if (byte == 0xF4)
+      utf8_high_ = 0x8F;
+  }
+  token_ += c;
+}
+
+void json_push_parser::escape_char(char c, error_code& ec)
+{
+  if (high_surrogate_ && c != 'u')
+  {
+    ec = bad_message();
+    return;
+  }
+  state_ = state::string;
+  switch (c)
+  {
+  case '"':
+  case '\\':
+  case '/':
+    token_ += c;
+    return;
+  case 'b':
+    token_ += '\b';
+    return;
+  case 'f':
+    token_ += '\f';
+    return;
+  case 'n':
+    token_ += '\n';
+    return;
+  case 'r':
+    token_ += '\r';
+    return;
+  case 't':
+    token_ += '\t';
+    return;
+  case 'u':
+    code_point_ = 0;
+    hex_digits_ = 0;
+    state_ = state::unicode;
+    return;
+  default:
+    ec = bad_message();
+    return;
+  }
+}
+
+void json_push_parser::unicode_char(char c, error_code& ec)
+{
+  auto const value = hex_value(c);
+  if (value < 0)
+  {
+    ec = bad_message();
+    return;
+  }
+  code_point_ = code_point_ * 16 + static_cast<std::uint32_t>(value);
+  if (++hex_digits_ < 4)
+    return;
+  state_ = state::string;
+  auto const is_high = code_point_ >= 0xD800 && code_point_ <= 0xDBFF;
+  auto const is_low = code_point_ >= 0xDC00 && code_point_ <= 0xDFFF;
+  if (high_surrogate_)
+  {
+    if (!is_low)
+    {
+      ec = bad_message();
+      return;
+    }
+    append_utf8(token_,
+                0x10000 + ((high_surrogate_ - 0xD800) << 10) +
+                    (code_point_ - 0xDC00));
+    high_surrogate_ = 0;
+  }
+  else if (is_high)
+    high_surrogate_ = code_point_;
+  else if (is_low)
+    ec = bad_message();
+  else
+    append_utf8(token_, code_point_);
+}
+
+void json_push_parser::end_string()
+{
+  if (key_)
+  {
+    state_ = state::colon;
+    return emit(sax_.key(token_));
+  }
+  emit(sax_.string(token_));
+  value_done();
+}
+
+void json_push_parser::end_number(error_code& ec)
+{
+  if (!is_valid_number(token_))
+  {
+    ec = bad_message();
+    return;
+  }
+  auto const first = token_.data();
+  auto const last = token_.data() + token_.size();
+  if (token_.find_first_of(".eE") == std::string::npos)
+  {
+    // integers out of range are read as floating point numbers
+    if (token_[0] == '-')
+    {
+      nlohmann::json::number_integer_t value;
+      auto const [end, error] = std::from_chars(first, last, value);
+      if (error == std::errc{} && end == last)
+      {
+        emit(sax_.number_integer(value));
+        return value_done();
+      }
+    }
+    else
+    {
+      nlohmann::json::number_unsigned_t value;
+      auto const [end, error] = std::from_chars(first, last, value);
+      if (error == std::errc{} && end == last)
+      {
+        emit(sax_.number_unsigned(value));
+        return value_done();
+      }
+    }
+  }
+  // strtod reads the decimal point of the current locale, the handler is
+  // given the number as it was written
+  auto localized = token_;
+  if (auto const point = localized.find('.'); point != std::string::npos)
+    localized[point] = *std::localeconv()->decimal_point;
+  auto const value = std::strtod(localized.c_str(), nullptr);
+  if (!std::isfinite(value))
+  {
+    ec = bad_message();
+    return;
+  }
+  emit(sax_.number_float(value, token_));
+  value_done();
+}
+
+void json_push_parser::end_container(bool object, error_code& ec)
+{
+  if (containers_.empty() || containers_.back() != object)
+  {
+    ec = bad_message();
+    return;
+  }
+  containers_.pop_back();
+  emit(object ? sax_.end_object() : sax_.end_array());
+  value_done();
+}
+}
@@ -0,0 +1,63 @@
+#include <fetchpp/http/fd_body.hpp>
+
+#include <boost/system/error_code.hpp>
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fetchpp::http::detail
+{
+namespace
+{
+error_code last_error()
+{
+  return error_code(errno, boost::system::system_category());
+}
+}
+
+void preallocate(int fd, std::uint64_t size, error_code& ec)
+{
+  ec = {};
+  if (size == 0)
+    return;
+  // pipes and sockets have no position, nor space to reserve
+  auto const offset = ::lseek(fd, 0, SEEK_CUR);
+  if (offset < 0)
+    return;
+#if defined(__linux__)
+  // posix_fallocate would emulate the reservation by writing zeros over the
+  // whole length where the file system cannot reserve space, the body is
+  // better written only once
+  while (::fallocate(fd, 0, offset, static_cast<off_t>(size)) != 0)
+  {
+    if (errno == EINTR)
+      continue;
+    if (errno != EOPNOTSUPP)
+      ec = last_error();
+    return;
+  }
+#endif
+}
+
+void write_all(int fd, net::const_buffer buffer, error_code& ec)
+{
+  ec = {};
+  auto const* data = static_cast<char const*>(buffer.data());
+  auto left = buffer.size();
+  while (left > 0)
+  {
+    auto const written = ::write(fd, data, left);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      ec = last_error();
+      return;
+    }
+    data += written;
+    left -= static_cast<std::size_t>(written);
+  }
+}
+}
@@ -0,0 +1,51 @@
+#include <fetchpp/http/fd_source_body.hpp>
+
+#include <boost/system/error_code.hpp>
+
+#include <cerrno>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace fetchpp::http::detail
+{
+file_mapping::~file_mapping()
+{
+  if (base_)
+    ::munmap(base_, length_);
+}
+
+void file_mapping::map(int fd,
+                       std::uint64_t offset,
+                       std::uint64_t size,
+                       error_code& ec)
+{
+  ec = {};
+  if (size == 0)
+    return;
+  // mappings start on a page boundary
+  auto const page = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+  auto const start = offset - offset % page;
+  skip_ = static_cast<std::size_t>(offset - start);
+  length_ = static_cast<std::size_t>(size) + skip_;
+  auto* base = ::mmap(
+      nullptr, length_, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(start));
+  if (base == MAP_FAILED)
+  {
+    ec = error_code(errno, boost::system::system_category());
+    length_ = 0;
+    return;
+  }
+  base_ = base;
+  // the range is read once, from the start to the end
+  ::posix_madvise(base_, length_, POSIX_MADV_SEQUENTIAL);
+}
+
+net::const_buffer file_mapping::data() const
+{
+  if (!base_)
+    return {};
+  return net::const_buffer(static_cast<char const*>(base_) + skip_,
+                           length_ - skip_);
+}
+}
@@ -0,0 +1,65 @@
+#include <fetchpp/http/request.hpp>
+
+namespace fetchpp::http
+{
+request_options::request_options(url uri) : _uri(std::move(uri))
+{
+}
+
+url const& request_options::uri() const
+{
+  return _uri;
+}
+
+std::optional<std::chrono::nanoseconds> request_options::timeout() const
+{
+  return _timeout;
+}
+
+void request_options::set_timeout(std::chrono::nanoseconds timeout)
+{
+  _timeout = timeout;
+}
+
+int request_options::priority() const
+{
+  return _priority;
+}
+
+void request_options::set_priority(int priority)
+{
+  _priority = priority;
+}
+
+std::optional<std::uint64_t> request_options::body_limit() const
+{
+  return _body_limit;
+}
+
+void request_options::set_body_limit(std::optional<std::uint64_t> limit)
+{
+  _body_limit = limit;
+  _body_limit_is_set = true;
+}
+
+bool request_options::body_limit_is_set() const
+{
+  return _body_limit_is_set;
+}
+
+std::optional<std::size_t> request_options::compression_threshold() const
+{
+  return _compression_threshold;
+}
+
+void request_options::set_compression_threshold(
+    std::optional<std::size_t> threshold)
+{
+  _compression_threshold = threshold;
+}
+
+bool request_options::accepts_compressed() const
+{
+  return _accepts_compressed;
+}
+}
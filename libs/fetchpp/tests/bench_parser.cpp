@@ -0,0 +1,85 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+
+#include <fetchpp/http/response.hpp>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/multi_buffer.hpp>
+#include <boost/beast/http/parser.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+namespace net = boost::asio;
+namespace bb = boost::beast;
+
+namespace
+{
+// a chunked json response, as a server would send it
+std::string make_raw_response(std::size_t body_size, std::size_t chunk_size)
+{
+  std::string body = "[";
+  while (body.size() < body_size)
+    body += R"({"id":12345,"name":"fetchpp","tags":["a","b","c"]},)";
+  body.back() = ']';
+
+  auto raw = std::string(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/json\r\n"
+      "Transfer-Encoding: chunked\r\n\r\n");
+  for (std::size_t offset = 0; offset < body.size(); offset += chunk_size)
+  {
+    auto const chunk = body.substr(offset, chunk_size);
+    raw += fmt::format("{:x}\r\n{}\r\n", chunk.size(), chunk);
+  }
+  raw += "0\r\n\r\n";
+  return raw;
+}
+
+// feeds the parser the way http::async_read does, read_size bytes at a time
+// through the read buffer of a transport
+template <typename ReadBuffer>
+std::size_t parse_through(std::string const& raw, std::size_t read_size)
+{
+  ReadBuffer buffer;
+  bb::http::response_parser<fetchpp::http::flat_response::body_type> parser;
+  parser.body_limit(boost::none);
+  std::size_t offset = 0;
+  bb::error_code ec;
+  while (!parser.is_done())
+  {
+    auto const n = std::min(read_size, raw.size() - offset);
+    buffer.commit(net::buffer_copy(buffer.prepare(n),
+                                   net::buffer(raw.data() + offset, n)));
+    offset += n;
+    buffer.consume(parser.put(buffer.data(), ec));
+    if (ec == bb::http::error::need_more)
+      ec = {};
+    if (ec)
+      throw bb::system_error(ec);
+  }
+  return parser.get().body().size();
+}
+}
+
+TEST_CASE("parser throughput by read buffer", "[benchmark][flat_buffer]")
+{
+  auto const read_size = GENERATE(std::size_t{1536}, std::size_t{65536});
+  auto const raw = make_raw_response(4 * 1024 * 1024, 16 * 1024);
+  CAPTURE(read_size);
+
+  BENCHMARK("multi_buffer")
+  {
+    return parse_through<bb::multi_buffer>(raw, read_size);
+  };
+  BENCHMARK("flat_buffer")
+  {
+    return parse_through<bb::flat_buffer>(raw, read_size);
+  };
+}
@@ -1,17 +1,24 @@
 #include <fetchpp/client.hpp>
+#include <fetchpp/sharded_client.hpp>
 
 #include <fetchpp/http/request.hpp>
 
 #include <boost/asio/use_future.hpp>
 
+#include "helpers/fake_server.hpp"
 #include "helpers/format.hpp"
 #include "helpers/ioc_fixture.hpp"
 #include "helpers/match_exception.hpp"
 #include "helpers/test_domain.hpp"
+#include "helpers/worker_fixture.hpp"
 
 #include <catch2/catch.hpp>
+#include <fmt/format.h>
 
 #include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -22,6 +29,7 @@ using fetchpp::string_view;
 using test::helpers::HasErrorCode;
 
 namespace ssl = fetchpp::net::ssl;
+namespace bb = boost::beast;
 using URL = fetchpp::http::url;
 
 namespace fetchpp
@@ -43,6 +51,23 @@ TEST_CASE_METHOD(ioc_fixture, "client push one request", "[client][http]")
   REQUIRE(cl.session_count() == 1);
 }
 
+TEST_CASE_METHOD(ioc_fixture,
+                 "client push one request into a flat response",
+                 "[client][http][flat_buffer]")
+{
+  fetchpp::client cl{ioc};
+  auto const url = fetchpp::http::url("get"_http);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, url);
+
+  auto res = cl.async_fetch(std::move(request),
+                            fetchpp::http::flat_response{},
+                            boost::asio::use_future)
+                 .get();
+  REQUIRE(res.result_int() == 200);
+  REQUIRE(res.is_json());
+  REQUIRE_NOTHROW(res.json());
+}
+
 TEST_CASE_METHOD(ioc_fixture, "client push two requests", "[client][http]")
 {
   fetchpp::client cl{ioc};
@@ -58,6 +83,188 @@ TEST_CASE_METHOD(ioc_fixture, "client push two requests", "[client][http]")
   REQUIRE(cl.session_count() == 2);
 }
 
+TEST_CASE_METHOD(ioc_fixture,
+                 "client reuses sessions per endpoint",
+                 "[client][http]")
+{
+  fetchpp::client cl{ioc};
+  cl.set_max_pending_per_session(1);
+  auto const url = fetchpp::http::url("get"_http);
+  auto const surl = fetchpp::http::url("get"_https);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, url);
+  auto srequest = fetchpp::http::request(fetchpp::http::verb::get, surl);
+
+  for (int i = 0; i < 3; ++i)
+  {
+    REQUIRE(cl.async_fetch(request, boost::asio::use_future).get().ok());
+    REQUIRE(cl.async_fetch(srequest, boost::asio::use_future).get().ok());
+  }
+  REQUIRE(cl.session_count() == 2);
+
+  std::deque<std::future<fetchpp::http::response>> futures;
+  for (int i = 0; i < 3; ++i)
+    futures.push_back(cl.async_fetch(request, boost::asio::use_future));
+  for (auto& future : futures)
+    REQUIRE_NOTHROW(future.get());
+  REQUIRE(cl.session_count() > 2);
+}
+
+TEST_CASE_METHOD(ioc_fixture,
+                 "client bounds its session count",
+                 "[client][http]")
+{
+  fetchpp::client cl{ioc};
+  cl.set_max_pending_per_session(1);
+  cl.set_max_sessions_per_host(2);
+  cl.set_max_sessions(3);
+  auto const url = fetchpp::http::url("get"_http);
+  auto const surl = fetchpp::http::url("get"_https);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, url);
+  auto srequest = fetchpp::http::request(fetchpp::http::verb::get, surl);
+
+  std::deque<std::future<fetchpp::http::response>> futures;
+  for (int i = 0; i < 5; ++i)
+  {
+    futures.push_back(cl.async_fetch(request, boost::asio::use_future));
+    futures.push_back(cl.async_fetch(srequest, boost::asio::use_future));
+  }
+  for (auto& future : futures)
+    REQUIRE(future.get().ok());
+  REQUIRE(cl.session_count() <= 3);
+  REQUIRE(cl.waiting_requests() == 0);
+}
+
+TEST_CASE_METHOD(ioc_fixture,
+                 "client closes idle sessions",
+                 "[client][http][delay]")
+{
+  fetchpp::client cl{ioc};
+  cl.set_idle_timeout(200ms);
+  auto const url = fetchpp::http::url("get"_http);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, url);
+
+  REQUIRE(cl.async_fetch(request, boost::asio::use_future).get().ok());
+  REQUIRE(cl.session_count() == 1);
+  std::this_thread::sleep_for(1s);
+  REQUIRE(cl.session_count() == 0);
+  REQUIRE(cl.async_fetch(request, boost::asio::use_future).get().ok());
+  REQUIRE(cl.session_count() == 1);
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "client recovers from a failed session",
+                 "[client][interrupt][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  fetchpp::client cl{worker().ex};
+  auto const url = URL(fmt::format("http://127.0.0.1:{}/get",
+                                   server.local_endpoint().port()));
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, url);
+
+  auto fut = cl.async_fetch(request, net::use_future);
+  for (int i = 0; i < 2; ++i)
+  {
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive_some(10, net::use_future).get());
+    REQUIRE_NOTHROW(fake_session.close());
+  }
+  REQUIRE_THROWS(fut.get());
+
+  INFO("the next request is not aborted");
+  fut = cl.async_fetch(request, net::use_future);
+  auto fake_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(
+      fake_session.async_reply_back(bb::http::status::ok, net::use_future)
+          .get());
+  REQUIRE(fut.get().result_int() == 200);
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "client routes priority requests to dedicated sessions",
+                 "[client][priority][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  fetchpp::client cl{worker().ex};
+  cl.set_priority_threshold(1);
+  auto const url = [&](auto target) {
+    return URL(fmt::format(
+        "http://127.0.0.1:{}{}", server.local_endpoint().port(), target));
+  };
+  auto low = fetchpp::http::request(fetchpp::http::verb::get, url("/low"));
+  auto high = fetchpp::http::request(fetchpp::http::verb::get, url("/high"));
+  high.set_priority(1);
+
+  auto low_fut = cl.async_fetch(low, net::use_future);
+  auto low_session = server.async_accept(net::use_future).get();
+  REQUIRE(low_session.async_receive(net::use_future).get().target() ==
+          "/low");
+
+  INFO("the priority request does not queue behind the running one");
+  auto high_fut = cl.async_fetch(high, net::use_future);
+  auto high_session = server.async_accept(net::use_future).get();
+  REQUIRE(high_session.async_receive(net::use_future).get().target() ==
+          "/high");
+  REQUIRE_NOTHROW(
+      high_session.async_send(bb::http::status::ok, "", net::use_future)
+          .get());
+  REQUIRE(high_fut.get().result_int() == 200);
+  REQUIRE_NOTHROW(
+      low_session.async_send(bb::http::status::ok, "", net::use_future).get());
+  REQUIRE(low_fut.get().result_int() == 200);
+  REQUIRE(cl.session_count() == 2);
+}
+
+TEST_CASE_METHOD(ioc_fixture,
+                 "client spreads requests across sessions",
+                 "[client][http][delay]")
+{
+  auto const policy = GENERATE(fetchpp::session_selection::least_pending,
+                               fetchpp::session_selection::power_of_two_choices,
+                               fetchpp::session_selection::round_robin);
+  fetchpp::client cl{ioc};
+  cl.set_session_selection(policy);
+  cl.set_max_pending_per_session(2);
+  auto const url = fetchpp::http::url("delay/1"_http);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, url);
+
+  std::deque<std::future<fetchpp::http::response>> futures;
+  for (int i = 0; i < 4; ++i)
+    futures.push_back(cl.async_fetch(request, boost::asio::use_future));
+  for (auto& future : futures)
+    REQUIRE(future.get().ok());
+  REQUIRE(cl.session_count() == 2);
+
+  futures.clear();
+  for (int i = 0; i < 2; ++i)
+    futures.push_back(cl.async_fetch(request, boost::asio::use_future));
+  std::this_thread::sleep_for(200ms);
+  auto const pending = cl.pending_tasks_per_session();
+  for (auto& future : futures)
+    REQUIRE(future.get().ok());
+  REQUIRE(pending == std::vector<std::size_t>{1, 1});
+}
+
+TEST_CASE_METHOD(ioc_fixture,
+                 "sharded client routes endpoints to shards",
+                 "[client][sharded][http]")
+{
+  fetchpp::sharded_client cl{ioc, 4};
+  auto const url = fetchpp::http::url("get"_http);
+  auto const surl = fetchpp::http::url("get"_https);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, url);
+  auto srequest = fetchpp::http::request(fetchpp::http::verb::get, surl);
+
+  REQUIRE(&cl.shard_for(url) == &cl.shard_for(request.uri()));
+  for (int i = 0; i < 3; ++i)
+  {
+    REQUIRE(cl.async_fetch(request, boost::asio::use_future).get().ok());
+    REQUIRE(cl.async_fetch(srequest, boost::asio::use_future).get().ok());
+  }
+  REQUIRE(cl.session_count() == 2);
+  REQUIRE(cl.shard_for(url).session_count() >= 1);
+  REQUIRE_NOTHROW(cl.async_stop(boost::asio::use_future).get());
+}
+
 TEST_CASE_METHOD(ioc_fixture, "client with delay", "[client][http][delay]")
 {
   fetchpp::client cl{ioc, 2s};
@@ -206,3 +413,22 @@ TEST_CASE_METHOD(ioc_fixture,
     REQUIRE_NOTHROW(cl.async_stop(boost::asio::use_future).get());
   }
 }
+
+TEST_CASE_METHOD(ioc_fixture,
+                 "client stop waits for retired sessions",
+                 "[client][http]")
+{
+  auto cl = std::make_unique<fetchpp::client>(ioc);
+  cl->set_max_sessions(1);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get,
+                                        fetchpp::http::url("get"_http));
+  auto srequest = fetchpp::http::request(fetchpp::http::verb::get,
+                                         fetchpp::http::url("get"_https));
+
+  REQUIRE(cl->async_fetch(request, boost::asio::use_future).get().ok());
+  INFO("the idle session is retired to make room for the other endpoint");
+  REQUIRE(cl->async_fetch(srequest, boost::asio::use_future).get().ok());
+  REQUIRE(cl->session_count() == 1);
+  REQUIRE_NOTHROW(cl->async_stop(boost::asio::use_future).get());
+  cl.reset();
+}
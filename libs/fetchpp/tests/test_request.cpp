@@ -1,7 +1,10 @@
 #include <fetchpp/http/content_type.hpp>
 #include <fetchpp/http/request.hpp>
+#include <fetchpp/http/response.hpp>
 #include <fetchpp/http/url.hpp>
 
+#include <fetchpp/http/detail/json_parser.hpp>
+
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/vector_body.hpp>
 
@@ -9,6 +12,11 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <clocale>
+#include <optional>
+#include <string>
+
 using namespace fetchpp::http::url_literals;
 using fetchpp::string_view;
 
@@ -106,3 +114,195 @@ TEST_CASE("request a buffer body", "[request]")
   req.content(fetchpp::net::buffer(vec));
   req.set(fetchpp::http::content_type("application/json", "utf8"));
 }
+
+namespace
+{
+// keeps the value of one key of the top level object
+struct key_sax : nlohmann::json_sax<nlohmann::json>
+{
+  std::string wanted;
+  std::size_t depth = 0;
+  bool matched = false;
+  std::optional<std::string> value;
+
+  explicit key_sax(std::string key) : wanted(std::move(key))
+  {
+  }
+
+  bool null() override
+  {
+    return done();
+  }
+  bool boolean(bool) override
+  {
+    return done();
+  }
+  bool number_integer(number_integer_t) override
+  {
+    return done();
+  }
+  bool number_unsigned(number_unsigned_t) override
+  {
+    return done();
+  }
+  bool number_float(number_float_t, string_t const&) override
+  {
+    return done();
+  }
+  bool string(string_t& val) override
+  {
+    if (matched && depth == 1)
+      value = val;
+    return done();
+  }
+  bool binary(binary_t&) override
+  {
+    return done();
+  }
+  bool start_object(std::size_t) override
+  {
+    ++depth;
+    return true;
+  }
+  bool key(string_t& val) override
+  {
+    matched = depth == 1 && val == wanted;
+    return true;
+  }
+  bool end_object() override
+  {
+    --depth;
+    return true;
+  }
+  bool start_array(std::size_t) override
+  {
+    ++depth;
+    return true;
+  }
+  bool end_array() override
+  {
+    --depth;
+    return true;
+  }
+  bool parse_error(std::size_t,
+                   std::string const&,
+                   nlohmann::detail::exception const&) override
+  {
+    return false;
+  }
+
+private:
+  // the parsing stops once the value is found
+  bool done()
+  {
+    matched = false;
+    return !value;
+  }
+};
+
+// pushes body to a json_push_parser, piece bytes at a time
+std::optional<nlohmann::json> push_json(std::string const& body,
+                                        std::size_t piece)
+{
+  nlohmann::json value;
+  fetchpp::http::detail::json_builder builder(value);
+  fetchpp::http::detail::json_push_parser parser(builder);
+  fetchpp::error_code ec;
+  for (std::size_t offset = 0; offset < body.size() && !ec; offset += piece)
+    parser.write(string_view(body).substr(offset, piece), ec);
+  if (!ec)
+    parser.finish(ec);
+  if (ec)
+    return std::nullopt;
+  return value;
+}
+
+template <typename Response>
+Response make_json_response(std::string const& body, std::size_t piece)
+{
+  Response res;
+  for (std::size_t offset = 0; offset < body.size(); offset += piece)
+  {
+    auto const n = std::min(piece, body.size() - offset);
+    res.body().commit(fetchpp::net::buffer_copy(
+        res.body().prepare(n), fetchpp::net::buffer(body.data() + offset, n)));
+  }
+  return res;
+}
+}
+
+TEMPLATE_TEST_CASE("response json is read from the body buffers",
+                   "[response][json]",
+                   fetchpp::http::response,
+                   fetchpp::http::flat_response)
+{
+  // large enough for the multi_buffer to be made of several buffers
+  nlohmann::json v{{"key", "value"}, {"list", {1, 2, 3}}};
+  for (auto i = 0; i < 200; ++i)
+    v["item" + std::to_string(i)] = i;
+  auto const res = make_json_response<TestType>(v.dump(), 64);
+  CHECK(res.json() == v);
+
+  key_sax sax("key");
+  CHECK_FALSE(res.json(sax));
+  CHECK(sax.value == "value");
+
+  auto const bad = make_json_response<TestType>("{\"key\":", 3);
+  CHECK_THROWS_AS(bad.json(), nlohmann::json::parse_error);
+  key_sax missing("key");
+  CHECK_FALSE(bad.json(missing));
+  CHECK_FALSE(missing.value);
+}
+
+TEST_CASE("json pushed in chunks is validated as the response json",
+          "[response][json]")
+{
+  auto const piece = GENERATE(std::size_t{1}, std::size_t{1024});
+  CAPTURE(piece);
+
+  SECTION("utf-8 is valid up to U+10FFFF, without surrogates")
+  {
+    for (auto const body : {"\"\xe0\xa0\x80\"",
+                            "\"\xed\x9f\xbf\"",
+                            "\"\xef\xbf\xbf\"",
+                            "\"\xf0\x90\x80\x80\"",
+                            "\"\xf4\x8f\xbf\xbf\""})
+    {
+      CAPTURE(body);
+      auto const res = make_json_response<fetchpp::http::response>(body, 1);
+      CHECK(push_json(body, piece) == res.json());
+    }
+  }
+
+  SECTION("overlong forms, surrogates and larger code points are rejected")
+  {
+    for (auto const body : {"\"\xc0\x80\"",
+                            "\"\xe0\x80\x80\"",
+                            "\"\xe0\x9f\xbf\"",
+                            "\"\xed\xa0\x80\"",
+                            "\"\xed\xbf\xbf\"",
+                            "\"\xf0\x8f\xbf\xbf\"",
+                            "\"\xf4\x90\x80\x80\"",
+                            "\"\xf5\x80\x80\x80\""})
+    {
+      CAPTURE(body);
+      auto const res = make_json_response<fetchpp::http::response>(body, 1);
+      CHECK_THROWS_AS(res.json(), nlohmann::json::parse_error);
+      CHECK_FALSE(push_json(body, piece));
+    }
+  }
+
+  SECTION("numbers do not depend on the locale")
+  {
+    std::string const previous = std::setlocale(LC_NUMERIC, nullptr);
+    if (!std::setlocale(LC_NUMERIC, "de_DE.UTF-8") &&
+        !std::setlocale(LC_NUMERIC, "fr_FR.UTF-8"))
+    {
+      WARN("no locale with a decimal comma, only the C locale is checked");
+    }
+    auto const body = std::string("[1.5,-2.25e1,0.125]");
+    auto const value = push_json(body, piece);
+    std::setlocale(LC_NUMERIC, previous.c_str());
+    CHECK(value == nlohmann::json({1.5, -22.5, 0.125}));
+  }
+}
@@ -1,10 +1,16 @@
 #include <fetchpp/core/session.hpp>
 
 #include <fetchpp/core/ssl_transport.hpp>
+#include <fetchpp/http/buffers_body.hpp>
 #include <fetchpp/http/request.hpp>
+#include <fetchpp/http/fd_body.hpp>
+#include <fetchpp/http/fd_source_body.hpp>
+#include <fetchpp/http/json_body.hpp>
 #include <fetchpp/http/response.hpp>
+#include <fetchpp/http/streaming_body.hpp>
 
 #include <fetchpp/core/detail/endpoint.hpp>
+#include <fetchpp/core/detail/recycling_pool.hpp>
 
 #include "helpers/fake_server.hpp"
 #include "helpers/format.hpp"
@@ -13,16 +19,23 @@
 #include "helpers/test_domain.hpp"
 #include "helpers/worker_fixture.hpp"
 
+#include <boost/asio/bind_cancellation_slot.hpp>
+#include <boost/asio/cancellation_signal.hpp>
 #include <boost/asio/ssl/context.hpp>
 #include <boost/asio/ssl/error.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/use_future.hpp>
+#include <boost/beast/http/string_body.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
 
 #include <fetchpp/alias/net.hpp>
 
 #include <array>
+#include <cstdio>
 #include <deque>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <catch2/catch.hpp>
 #include <fmt/format.h>
@@ -183,6 +196,889 @@ TEST_CASE_METHOD(worker_fixture,
   REQUIRE_NOTHROW(session.async_stop(net::use_future).get());
 }
 
+TEST_CASE_METHOD(worker_fixture,
+                 "session pipelines multiple requests",
+                 "[session][push][pipeline][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker(2).ex, 30s);
+  session.set_pipeline_depth(4);
+  auto fut = session.async_start(net::use_future);
+  auto fake_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(fut.get());
+  auto request = fetchpp::http::request(fetchpp::http::verb::get,
+                                        fetchpp::http::url("get"_http));
+
+  // hold the session's worker so that all the requests are queued at once
+  std::promise<void> hold;
+  net::post(worker(2).ex, [f = hold.get_future()]() mutable { f.wait(); });
+  std::deque<std::tuple<std::future<void>, fetchpp::http::response>> results{5};
+  for (auto& [fut, response] : results)
+    fut = session.push_request(request, response, boost::asio::use_future);
+  hold.set_value();
+
+  INFO("the first four requests are received before any reply");
+  for (auto i = 0; i < 4; ++i)
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+  for (auto i = 0; i < 4; ++i)
+  {
+    REQUIRE_NOTHROW(
+        fake_session.async_send(bb::http::status::ok, "", net::use_future)
+            .get());
+    auto& [fut, response] = results.front();
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(response.result_int() == 200);
+    results.pop_front();
+  }
+  REQUIRE_NOTHROW(
+      fake_session.async_reply_back(bb::http::status::ok, net::use_future)
+          .get());
+  REQUIRE_NOTHROW(std::get<0>(results.front()).get());
+  REQUIRE_NOTHROW(session.async_stop(net::use_future).get());
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session retries a failed pipelined request by its policy",
+                 "[session][pipeline][retry][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker(2).ex, 30s);
+  session.set_pipeline_depth(4);
+  fetchpp::retry_policy policy;
+  policy.max_attempts = 1;
+  session.set_retry_policy(policy);
+  auto fut = session.async_start(net::use_future);
+  auto fake_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(fut.get());
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+
+  std::promise<void> hold;
+  net::post(worker(2).ex, [f = hold.get_future()]() mutable { f.wait(); });
+  fetchpp::http::response first_response, second_response;
+  auto first = session.push_request(request, first_response, net::use_future);
+  auto second =
+      session.push_request(request, second_response, net::use_future);
+  hold.set_value();
+
+  REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+  REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+  fake_session.close();
+
+  INFO("the failed request is not retried past its policy");
+  REQUIRE_THROWS(first.get());
+  CHECK(session.retries() == 0);
+
+  INFO("the unanswered request is sent again on its own");
+  auto next_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(
+      next_session.async_reply_back(bb::http::status::ok, net::use_future)
+          .get());
+  REQUIRE_NOTHROW(second.get());
+  REQUIRE(second_response.result_int() == 200);
+  REQUIRE_NOTHROW(session.async_stop(net::use_future).get());
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session does not pipeline requests with a deadline",
+                 "[session][pipeline][timeout][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker(2).ex, 30s);
+  session.set_pipeline_depth(4);
+  auto fut = session.async_start(net::use_future);
+  auto fake_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(fut.get());
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+  auto hurried = request;
+  hurried.set_timeout(100ms);
+
+  std::promise<void> hold;
+  net::post(worker(2).ex, [f = hold.get_future()]() mutable { f.wait(); });
+  fetchpp::http::response first_response, hurried_response, last_response;
+  auto first = session.push_request(request, first_response, net::use_future);
+  auto expiring =
+      session.push_request(hurried, hurried_response, net::use_future);
+  auto last = session.push_request(request, last_response, net::use_future);
+  hold.set_value();
+
+  REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+  REQUIRE_NOTHROW(
+      fake_session.async_send(bb::http::status::ok, "", net::use_future)
+          .get());
+  REQUIRE_NOTHROW(first.get());
+
+  INFO("the request with a deadline is sent alone and expires alone");
+  REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+  REQUIRE(expiring.wait_for(5s) == std::future_status::ready);
+  REQUIRE_THROWS_MATCHES(expiring.get(),
+                         boost::system::system_error,
+                         HasErrorCode(boost::beast::error::timeout));
+
+  auto next_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(
+      next_session.async_reply_back(bb::http::status::ok, net::use_future)
+          .get());
+  REQUIRE_NOTHROW(last.get());
+  REQUIRE(last_response.result_int() == 200);
+  REQUIRE_NOTHROW(session.async_stop(net::use_future).get());
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session expires requests past their deadline",
+                 "[session][timeout][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+  auto hurried = request;
+  hurried.set_timeout(100ms);
+
+  fetchpp::http::response first_response;
+  auto first = session.push_request(request, first_response, net::use_future);
+  auto fake_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+
+  INFO("a queued request expires without disturbing the running one");
+  fetchpp::http::response queued_response;
+  auto queued =
+      session.push_request(hurried, queued_response, net::use_future);
+  REQUIRE_THROWS_MATCHES(queued.get(),
+                         boost::system::system_error,
+                         HasErrorCode(boost::beast::error::timeout));
+  REQUIRE_NOTHROW(
+      fake_session.async_send(bb::http::status::ok, "", net::use_future)
+          .get());
+  REQUIRE_NOTHROW(first.get());
+  REQUIRE(first_response.result_int() == 200);
+
+  INFO("a running request expires and leaves the session running");
+  fetchpp::http::response running_response;
+  auto running =
+      session.push_request(hurried, running_response, net::use_future);
+  REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+  REQUIRE_THROWS_MATCHES(running.get(),
+                         boost::system::system_error,
+                         HasErrorCode(boost::beast::error::timeout));
+  REQUIRE(session.running());
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session honors cancellation slots",
+                 "[session][cancel][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+
+  fetchpp::http::response first_response;
+  net::cancellation_signal first_signal;
+  auto first = session.push_request(
+      request,
+      first_response,
+      net::bind_cancellation_slot(first_signal.slot(), net::use_future));
+  auto fake_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+
+  INFO("a queued request leaves the queue");
+  fetchpp::http::response queued_response;
+  net::cancellation_signal queued_signal;
+  auto queued = session.push_request(
+      request,
+      queued_response,
+      net::bind_cancellation_slot(queued_signal.slot(), net::use_future));
+  REQUIRE(queued.wait_for(50ms) == std::future_status::timeout);
+  queued_signal.emit(net::cancellation_type::terminal);
+  REQUIRE_THROWS_MATCHES(queued.get(),
+                         boost::system::system_error,
+                         HasErrorCode(net::error::operation_aborted));
+
+  INFO("a running request drops its connection");
+  first_signal.emit(net::cancellation_type::terminal);
+  REQUIRE_THROWS_MATCHES(first.get(),
+                         boost::system::system_error,
+                         HasErrorCode(net::error::operation_aborted));
+  REQUIRE(session.running());
+
+  INFO("the next request gets a new connection");
+  fetchpp::http::response next_response;
+  auto next = session.push_request(request, next_response, net::use_future);
+  auto next_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(next_session.async_receive(net::use_future).get());
+  REQUIRE_NOTHROW(
+      next_session.async_send(bb::http::status::ok, "", net::use_future).get());
+  REQUIRE_NOTHROW(next.get());
+  REQUIRE(next_response.result_int() == 200);
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session serves higher priorities first",
+                 "[session][priority][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto const url = [&](auto target) {
+    return URL(tcp_endpoint_to_url(server.local_endpoint(), target, "http"));
+  };
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(url("/get")), worker().ex, 30s);
+  session.set_priority_aging(0ns);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, url("/get"));
+  auto low = fetchpp::http::request(fetchpp::http::verb::get, url("/low"));
+  auto high = fetchpp::http::request(fetchpp::http::verb::get, url("/high"));
+  high.set_priority(1);
+
+  fetchpp::http::response first_response;
+  auto first = session.push_request(request, first_response, net::use_future);
+  auto fake_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+
+  fetchpp::http::response low_response;
+  auto low_fut = session.push_request(low, low_response, net::use_future);
+  fetchpp::http::response high_response;
+  auto high_fut = session.push_request(high, high_response, net::use_future);
+  REQUIRE(high_fut.wait_for(50ms) == std::future_status::timeout);
+  REQUIRE_NOTHROW(
+      fake_session.async_send(bb::http::status::ok, "", net::use_future)
+          .get());
+  REQUIRE_NOTHROW(first.get());
+
+  for (auto const* target : {"/high", "/low"})
+  {
+    auto const received = fake_session.async_receive(net::use_future).get();
+    REQUIRE(received.target() == target);
+    REQUIRE_NOTHROW(
+        fake_session.async_send(bb::http::status::ok, "", net::use_future)
+            .get());
+  }
+  REQUIRE_NOTHROW(high_fut.get());
+  REQUIRE_NOTHROW(low_fut.get());
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session recycles the memory of its requests",
+                 "[session][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+
+  // a few exchanges warm the pool up, the next ones take all their memory
+  // from it
+  auto const require_recycled = [&](auto& response, auto const& check) {
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    auto const exchange = [&] {
+      REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+      REQUIRE_NOTHROW(fake_session
+                          .async_send(bb::http::status::ok,
+                                      "application/json",
+                                      R"({"data": "some"})",
+                                      net::use_future)
+                          .get());
+      REQUIRE_NOTHROW(fut.get());
+      check(response);
+    };
+    exchange();
+    for (int i = 0; i < 2; ++i)
+    {
+      fut = session.push_request(request, response, net::use_future);
+      exchange();
+    }
+
+    auto const allocations = session.allocations();
+    for (int i = 0; i < 5; ++i)
+    {
+      fut = session.push_request(request, response, net::use_future);
+      exchange();
+    }
+    REQUIRE(session.allocations() == allocations);
+    REQUIRE(session.memory_pool()->reuses() > 0);
+  };
+
+  SECTION("into a response")
+  {
+    fetchpp::http::response response;
+    require_recycled(response, [](auto const& response) {
+      REQUIRE(response.json() == nlohmann::json({{"data", "some"}}));
+    });
+  }
+  SECTION("into a response whose header fields come from the pool")
+  {
+    using response_type = bb::http::response<bb::http::string_body,
+                                             fetchpp::detail::pooled_fields>;
+    response_type response(
+        std::piecewise_construct,
+        std::make_tuple(),
+        std::make_tuple(fetchpp::detail::recycling_allocator<char>(
+            session.memory_pool())));
+    std::size_t capacity = 0;
+    require_recycled(response, [&](auto const& response) {
+      REQUIRE(response.body() == R"({"data": "some"})");
+      // the body keeps its capacity from one response to the next
+      if (capacity == 0)
+        capacity = response.body().capacity();
+      REQUIRE(response.body().capacity() == capacity);
+    });
+  }
+  SECTION("with a compressed request body")
+  {
+    request.content(std::string(4096, 'x'));
+    request.set_compression_threshold(1024);
+    fetchpp::http::response response;
+    require_recycled(response, [](auto const& response) {
+      REQUIRE(response.result_int() == 200);
+    });
+  }
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session streams response bodies",
+                 "[session][streaming][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+  auto const payload = std::string(256 * 1024, 'x');
+
+  SECTION("the sink receives the whole body")
+  {
+    std::string received;
+    std::size_t chunks = 0;
+    fetchpp::http::streaming_response response;
+    response.body().sink = [&](net::const_buffer buffer, fetchpp::error_code&) {
+      received.append(static_cast<char const*>(buffer.data()), buffer.size());
+      ++chunks;
+    };
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    REQUIRE_NOTHROW(
+        fake_session.async_send(bb::http::status::ok, payload, net::use_future)
+            .get());
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(received == payload);
+    REQUIRE(chunks > 1);
+    REQUIRE(response.body().delivered == payload.size());
+  }
+  SECTION("an asynchronous sink receives the whole body")
+  {
+    std::string received;
+    std::size_t pending = 0;
+    net::steady_timer delay(worker(1).ex);
+    fetchpp::http::streaming_response response;
+    response.body().async_sink =
+        [&](net::const_buffer buffer,
+            std::function<void(fetchpp::error_code)> handler) {
+          ++pending;
+          received.append(static_cast<char const*>(buffer.data()),
+                          buffer.size());
+          // the chunk is released later, from another executor
+          delay.expires_after(1ms);
+          delay.async_wait([&, handler](fetchpp::error_code) {
+            --pending;
+            handler({});
+          });
+        };
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    REQUIRE_NOTHROW(
+        fake_session.async_send(bb::http::status::ok, payload, net::use_future)
+            .get());
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(received == payload);
+    REQUIRE(pending == 0);
+    REQUIRE(response.body().delivered == payload.size());
+  }
+  SECTION("an asynchronous sink stops the transfer")
+  {
+    fetchpp::http::streaming_response response;
+    response.body().async_sink =
+        [](net::const_buffer, std::function<void(fetchpp::error_code)> handler) {
+          handler(boost::system::errc::make_error_code(
+              boost::system::errc::no_space_on_device));
+        };
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    fake_session.async_send(bb::http::status::ok, payload, net::use_future);
+    REQUIRE_THROWS_MATCHES(fut.get(),
+                           boost::system::system_error,
+                           HasErrorCode(boost::system::errc::make_error_code(
+                               boost::system::errc::no_space_on_device)));
+  }
+  SECTION("the sink stops the transfer")
+  {
+    fetchpp::http::streaming_response response(
+        std::piecewise_construct,
+        std::make_tuple([](net::const_buffer, fetchpp::error_code& ec) {
+          ec = boost::system::errc::make_error_code(
+              boost::system::errc::no_space_on_device);
+        }));
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    fake_session.async_send(bb::http::status::ok, payload, net::use_future);
+    REQUIRE_THROWS_MATCHES(fut.get(),
+                           boost::system::system_error,
+                           HasErrorCode(boost::system::errc::make_error_code(
+                               boost::system::errc::no_space_on_device)));
+  }
+  SECTION("a body larger than the limit of the request fails")
+  {
+    request.set_body_limit(1024);
+    fetchpp::http::response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    fake_session.async_send(bb::http::status::ok, payload, net::use_future);
+    REQUIRE_THROWS_MATCHES(fut.get(),
+                           boost::system::system_error,
+                           HasErrorCode(bb::http::error::body_limit));
+  }
+}
+
+namespace
+{
+// counts the members of the top level object, and stops after limit
+struct member_counter : nlohmann::json_sax<nlohmann::json>
+{
+  std::size_t limit;
+  std::size_t depth = 0;
+  std::size_t members = 0;
+
+  explicit member_counter(std::size_t l) : limit(l)
+  {
+  }
+
+  bool null() override
+  {
+    return true;
+  }
+  bool boolean(bool) override
+  {
+    return true;
+  }
+  bool number_integer(number_integer_t) override
+  {
+    return true;
+  }
+  bool number_unsigned(number_unsigned_t) override
+  {
+    return true;
+  }
+  bool number_float(number_float_t, string_t const&) override
+  {
+    return true;
+  }
+  bool string(string_t&) override
+  {
+    return true;
+  }
+  bool binary(binary_t&) override
+  {
+    return true;
+  }
+  bool start_object(std::size_t) override
+  {
+    ++depth;
+    return true;
+  }
+  bool key(string_t&) override
+  {
+    if (depth == 1)
+      ++members;
+    return members < limit;
+  }
+  bool end_object() override
+  {
+    --depth;
+    return true;
+  }
+  bool start_array(std::size_t) override
+  {
+    ++depth;
+    return true;
+  }
+  bool end_array() override
+  {
+    --depth;
+    return true;
+  }
+  bool parse_error(std::size_t,
+                   std::string const&,
+                   nlohmann::detail::exception const&) override
+  {
+    return false;
+  }
+};
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session parses json response bodies as they are read",
+                 "[session][json_body][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+  nlohmann::json document;
+  for (auto i = 0; i < 5000; ++i)
+    document["item" + std::to_string(i)] = {{"id", i}, {"name", "fetchpp"}};
+  auto const payload = document.dump();
+
+  SECTION("the document is built")
+  {
+    fetchpp::http::json_response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    REQUIRE_NOTHROW(
+        fake_session.async_send(bb::http::status::ok, payload, net::use_future)
+            .get());
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(response.body().value == document);
+    REQUIRE(response.body().delivered == payload.size());
+  }
+  SECTION("the events go to a sax handler, which stops the parsing")
+  {
+    member_counter counter(10);
+    fetchpp::http::json_response response(std::piecewise_construct,
+                                          std::forward_as_tuple(counter));
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    REQUIRE_NOTHROW(
+        fake_session.async_send(bb::http::status::ok, payload, net::use_future)
+            .get());
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(counter.members == 10);
+    REQUIRE(response.body().value.is_null());
+    INFO("the rest of the body is read");
+    REQUIRE(response.body().delivered == payload.size());
+  }
+  SECTION("malformed json fails the response")
+  {
+    fetchpp::http::json_response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    fake_session.async_send(bb::http::status::ok,
+                            payload.substr(0, payload.size() - 1),
+                            net::use_future);
+    REQUIRE_THROWS_MATCHES(fut.get(),
+                           boost::system::system_error,
+                           HasErrorCode(boost::system::errc::make_error_code(
+                               boost::system::errc::bad_message)));
+  }
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session decodes compressed response bodies",
+                 "[session][decoding_body][fake]")
+{
+  // {"data":"compressed"}, gzipped
+  static char const encoded[] =
+      "\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\x03\xab\x56\x4a\x49\x2c\x49\x54"
+      "\xb2\x52\x4a\xce\xcf\x2d\x28\x4a\x2d\x2e\x4e\x4d\x51\xaa\x05\x00\xa7"
+      "\x4e\x3a\xe1\x15\x00\x00\x00";
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+  auto const encoded_body = std::string(encoded, sizeof(encoded) - 1);
+
+  auto const reply_gzipped = [&](auto& fake_session) {
+    auto received = fake_session.async_receive(net::use_future).get();
+    auto reply = bb::http::response<bb::http::string_body>(
+        bb::http::status::ok, 11, encoded_body);
+    reply.set(bb::http::field::content_type, "application/json");
+    reply.set(bb::http::field::content_encoding, "gzip");
+    reply.prepare_payload();
+    REQUIRE_NOTHROW(
+        fake_session.async_send(std::move(reply), net::use_future).get());
+    return received;
+  };
+
+  SECTION("when the request accepts them")
+  {
+    request.accept_compressed();
+    fetchpp::http::response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    auto const received = reply_gzipped(fake_session);
+    REQUIRE(received[bb::http::field::accept_encoding] == "gzip, deflate");
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(response.result_int() == 200);
+    REQUIRE(response.json() == nlohmann::json({{"data", "compressed"}}));
+    // the header describes the body as it is stored
+    REQUIRE(response.find(bb::http::field::content_encoding) ==
+            response.end());
+    REQUIRE(response.content_length() == response.body().size());
+  }
+  SECTION("into a json document when the request accepts them")
+  {
+    request.accept_compressed();
+    fetchpp::http::json_response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    reply_gzipped(fake_session);
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(response.body().value ==
+            nlohmann::json({{"data", "compressed"}}));
+    REQUIRE(response.find(bb::http::field::content_encoding) ==
+            response.end());
+  }
+  SECTION("unless the request did not ask for them")
+  {
+    fetchpp::http::response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    auto const received = reply_gzipped(fake_session);
+    REQUIRE(received.find(bb::http::field::accept_encoding) ==
+            received.end());
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(response[bb::http::field::content_encoding] == "gzip");
+    REQUIRE(response.text() == encoded_body);
+  }
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session bounds decoded response bodies by the body limit",
+                 "[session][decoding_body][json_body][fake]")
+{
+  // a json array of 2048 zeros, 4097 bytes once decoded, gzipped
+  static char const encoded[] =
+      "\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\x03\xed\xc2\x31\x0d\x00\x00\x08"
+      "\x03\x30\x43\x1c\xf3\x43\xf0\x6f\x03\x1f\x4b\xd3\x6e\x06\x00\x00\x00"
+      "\x28\x77\x0f\x7b\xe2\x34\x41\x01\x10\x00\x00";
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+  request.accept_compressed();
+  request.set_body_limit(1024);
+
+  auto const reply_gzipped = [&](auto& fake_session) {
+    auto reply = bb::http::response<bb::http::string_body>(
+        bb::http::status::ok, 11, std::string(encoded, sizeof(encoded) - 1));
+    reply.set(bb::http::field::content_encoding, "gzip");
+    reply.prepare_payload();
+    fake_session.async_send(std::move(reply), net::use_future);
+  };
+
+  SECTION("into a dynamic buffer")
+  {
+    fetchpp::http::response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    reply_gzipped(fake_session);
+    REQUIRE_THROWS_MATCHES(fut.get(),
+                           boost::system::system_error,
+                           HasErrorCode(bb::http::error::body_limit));
+  }
+  SECTION("into a json document")
+  {
+    fetchpp::http::json_response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    reply_gzipped(fake_session);
+    REQUIRE_THROWS_MATCHES(fut.get(),
+                           boost::system::system_error,
+                           HasErrorCode(bb::http::error::body_limit));
+  }
+  SECTION("unless the limit is raised")
+  {
+    request.set_body_limit(4097);
+    fetchpp::http::response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+    reply_gzipped(fake_session);
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(response.json() == nlohmann::json(std::vector<int>(2048, 0)));
+  }
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session compresses large request bodies",
+                 "[session][compressing_body][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/post", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto const payload = nlohmann::json(std::vector<int>(10000, 42)).dump();
+  auto request = fetchpp::http::request(fetchpp::http::verb::post, URL(dest));
+  request.content(payload);
+  request.set_compression_threshold(1024);
+  fetchpp::http::response response;
+  auto fut = session.push_request(request, response, net::use_future);
+  auto fake_session = server.async_accept(net::use_future).get();
+
+  bb::http::request<fetchpp::http::decoding_body<bb::multi_buffer>> received;
+  received.body().decode_content(true);
+  REQUIRE_NOTHROW(fake_session.async_receive(received, net::use_future).get());
+  REQUIRE(received[bb::http::field::content_encoding] == "gzip");
+  REQUIRE(received.chunked());
+  REQUIRE(bb::buffers_to_string(received.body().cdata()) == payload);
+  REQUIRE_NOTHROW(
+      fake_session.async_send(bb::http::status::ok, "", net::use_future)
+          .get());
+  REQUIRE_NOTHROW(fut.get());
+  REQUIRE(response.result_int() == 200);
+  // the request is left as it is, a retry compresses it again
+  REQUIRE(request.find(bb::http::field::content_encoding) == request.end());
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session writes response bodies to files",
+                 "[session][fd_body][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+  auto const payload = std::string(512 * 1024, 'x');
+  auto file = std::unique_ptr<std::FILE, decltype(&std::fclose)>(
+      std::tmpfile(), &std::fclose);
+  REQUIRE(file);
+
+  fetchpp::http::fd_response response;
+  response.body().fd = ::fileno(file.get());
+  auto fut = session.push_request(request, response, net::use_future);
+  auto fake_session = server.async_accept(net::use_future).get();
+  REQUIRE_NOTHROW(fake_session.async_receive(net::use_future).get());
+  REQUIRE_NOTHROW(
+      fake_session.async_send(bb::http::status::ok, payload, net::use_future)
+          .get());
+  REQUIRE_NOTHROW(fut.get());
+  REQUIRE(response.result_int() == 200);
+  REQUIRE(response.body().delivered == payload.size());
+
+  std::rewind(file.get());
+  std::string written(payload.size() + 1, '\0');
+  REQUIRE(std::fread(written.data(), 1, written.size(), file.get()) ==
+          payload.size());
+  written.resize(payload.size());
+  REQUIRE(written == payload);
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session sends request bodies without copying them",
+                 "[session][fd_source_body][buffers_body][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/post", "http");
+  auto session = fetchpp::session(
+      fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+  auto const payload = std::string(512 * 1024, 'x') + "tail";
+
+  SECTION("from a range of a file")
+  {
+    auto file = std::unique_ptr<std::FILE, decltype(&std::fclose)>(
+        std::tmpfile(), &std::fclose);
+    REQUIRE(file);
+    REQUIRE(std::fwrite(payload.data(), 1, payload.size(), file.get()) ==
+            payload.size());
+    REQUIRE(std::fflush(file.get()) == 0);
+
+    auto request = fetchpp::http::fd_request(
+        fetchpp::http::verb::post,
+        URL(dest),
+        {::fileno(file.get()), 4, payload.size() - 4});
+    fetchpp::http::response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    auto received = fake_session.async_receive(net::use_future).get();
+    REQUIRE(received.body() == payload.substr(4));
+    REQUIRE_NOTHROW(
+        fake_session.async_send(bb::http::status::ok, "", net::use_future)
+            .get());
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(response.result_int() == 200);
+  }
+  SECTION("from the memory of the caller")
+  {
+    auto request = fetchpp::http::buffers_request<>(
+        fetchpp::http::verb::post, URL(dest), net::buffer(payload));
+    fetchpp::http::response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    auto received = fake_session.async_receive(net::use_future).get();
+    REQUIRE(received.body() == payload);
+    REQUIRE_NOTHROW(
+        fake_session.async_send(bb::http::status::ok, "", net::use_future)
+            .get());
+    REQUIRE_NOTHROW(fut.get());
+    REQUIRE(response.result_int() == 200);
+  }
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "session retries according to its policy",
+                 "[session][interrupt][retry][fake]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto dest = tcp_endpoint_to_url(server.local_endpoint(), "/get", "http");
+  fetchpp::retry_policy policy;
+  policy.max_attempts = 3;
+  policy.base_backoff = 10ms;
+
+  SECTION("idempotent requests are retried")
+  {
+    auto session = fetchpp::session(
+        fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+    session.set_retry_policy(policy);
+    auto request = fetchpp::http::request(fetchpp::http::verb::get, URL(dest));
+    fetchpp::http::response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    for (auto i = 0; i < 3; ++i)
+    {
+      auto fake_session = server.async_accept(net::use_future).get();
+      REQUIRE_NOTHROW(
+          fake_session.async_receive_some(10, net::use_future).get());
+      REQUIRE_NOTHROW(fake_session.close());
+    }
+    REQUIRE_THROWS(fut.get());
+    CHECK(session.retries() == 2);
+  }
+  SECTION("other requests are not")
+  {
+    auto session = fetchpp::session(
+        fetchpp::detail::to_endpoint<false>(URL(dest)), worker().ex, 30s);
+    session.set_retry_policy(policy);
+    auto request =
+        fetchpp::http::request(fetchpp::http::verb::post, URL(dest));
+    fetchpp::http::response response;
+    auto fut = session.push_request(request, response, net::use_future);
+    auto fake_session = server.async_accept(net::use_future).get();
+    REQUIRE_NOTHROW(fake_session.async_receive_some(10, net::use_future).get());
+    REQUIRE_NOTHROW(fake_session.close());
+    REQUIRE_THROWS(fut.get());
+    CHECK(session.retries() == 0);
+  }
+}
+
 TEST_CASE_METHOD(worker_fixture,
                  "session is interrupted once while pushing multiple requests",
                  "[session][interrupt][fake]")
@@ -1,11 +1,15 @@
+#include <fetchpp/core/dns_cache.hpp>
 #include <fetchpp/core/process_one.hpp>
+#include <fetchpp/core/ssl_session_cache.hpp>
 #include <fetchpp/core/ssl_transport.hpp>
 #include <fetchpp/core/tcp_transport.hpp>
 #include <fetchpp/http/request.hpp>
 #include <fetchpp/http/response.hpp>
 
 #include <fetchpp/core/detail/endpoint.hpp>
+#include <fetchpp/core/detail/happy_eyeballs.hpp>
 
+#include <boost/asio/post.hpp>
 #include <boost/asio/ssl/context.hpp>
 #include <boost/asio/use_future.hpp>
 
@@ -24,6 +28,7 @@
 #include <fmt/format.h>
 
 #include <chrono>
+#include <thread>
 
 using namespace std::chrono_literals;
 
@@ -114,6 +119,131 @@ TEST_CASE_METHOD(ioc_fixture,
   REQUIRE_NOTHROW(ts.async_close(boost::asio::use_future).get());
 }
 
+TEST_CASE_METHOD(ioc_fixture,
+                 "transport one tcp flat buffer",
+                 "[http][transport][flat_buffer]")
+{
+  auto const url = URL("get"_http);
+
+  fetchpp::tcp_flat_async_transport ts(ioc.get_executor(), 5s);
+  auto endpoint = fetchpp::detail::to_endpoint<false>(url);
+  REQUIRE_NOTHROW(ts.async_connect(endpoint, boost::asio::use_future).get());
+  auto const request = fetchpp::http::request(fetchpp::http::verb::get, url);
+  fetchpp::http::flat_response response;
+  REQUIRE_NOTHROW(
+      fetchpp::async_process_one(ts, request, response, boost::asio::use_future)
+          .get());
+  CHECK(response.result_int() == 200);
+  CHECK_NOTHROW(response.json());
+  REQUIRE_NOTHROW(ts.async_close(boost::asio::use_future).get());
+}
+
+TEST_CASE("connection races alternate address families", "[transport]")
+{
+  auto const at = [](auto a) {
+    return fetchpp::tcp::endpoint(boost::asio::ip::make_address(a), 80);
+  };
+  std::vector<fetchpp::tcp::endpoint> const endpoints{at("::1"),
+                                                      at("::2"),
+                                                      at("::3"),
+                                                      at("127.0.0.1"),
+                                                      at("127.0.0.2")};
+  auto const results = fetchpp::tcp::resolver::results_type::create(
+      endpoints.begin(), endpoints.end(), "host", "80");
+  auto const interleaved =
+      fetchpp::detail::interleave_address_families(results);
+  REQUIRE(interleaved.size() == 5);
+  CHECK(interleaved[0] == at("::1"));
+  CHECK(interleaved[1] == at("127.0.0.1"));
+  CHECK(interleaved[2] == at("::2"));
+  CHECK(interleaved[3] == at("127.0.0.2"));
+  CHECK(interleaved[4] == at("::3"));
+}
+
+TEST_CASE_METHOD(ioc_fixture,
+                 "transports share resolutions through a dns cache",
+                 "[transport][http][dns]")
+{
+  auto const url = URL("get"_http);
+  auto cache = std::make_shared<fetchpp::dns_cache>(ioc.get_executor());
+  auto endpoint = fetchpp::detail::to_endpoint<false>(url);
+
+  for (auto i = 0; i < 2; ++i)
+  {
+    fetchpp::tcp_async_transport ts(ioc.get_executor(), 5s);
+    ts.set_dns_cache(cache);
+    REQUIRE_NOTHROW(ts.async_connect(endpoint, boost::asio::use_future).get());
+    REQUIRE_NOTHROW(ts.async_close(boost::asio::use_future).get());
+  }
+  CHECK(cache->misses() == 1);
+  CHECK(cache->hits() == 1);
+
+  auto bad = fetchpp::plain_endpoint("does-not-exist.invalid", 80);
+  for (auto i = 0; i < 2; ++i)
+  {
+    fetchpp::tcp_async_transport ts(ioc.get_executor(), 5s);
+    ts.set_dns_cache(cache);
+    CHECK_THROWS(ts.async_connect(bad, boost::asio::use_future).get());
+  }
+  INFO("resolution failures are cached too");
+  CHECK(cache->hits() == 2);
+}
+
+TEST_CASE_METHOD(worker_fixture,
+                 "transport connects twice through a dns cache",
+                 "[fake][transport][dns]")
+{
+  test::helpers::fake_server server(worker(1).ex);
+  auto cache = std::make_shared<fetchpp::dns_cache>(worker().ex);
+  auto endpoint = fetchpp::plain_endpoint(
+      server.local_endpoint().address().to_string(),
+      server.local_endpoint().port());
+
+  for (auto i = 0; i < 2; ++i)
+  {
+    fetchpp::tcp_async_transport ts(worker().ex, 5s);
+    ts.set_dns_cache(cache);
+    auto future = ts.async_connect(endpoint, boost::asio::use_future);
+    auto fake_session = server.async_accept(fetchpp::net::use_future).get();
+    INFO("connection " << i);
+    REQUIRE_NOTHROW(future.get());
+    REQUIRE_NOTHROW(ts.async_close(boost::asio::use_future).get());
+  }
+  CHECK(cache->misses() == 1);
+  CHECK(cache->hits() == 1);
+}
+
+TEST_CASE_METHOD(ioc_fixture, "dns cache evicts entries", "[dns]")
+{
+  auto const results = fetchpp::tcp::resolver::results_type::create(
+      fetchpp::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 80),
+      "host",
+      "80");
+
+  SECTION("past max_entries")
+  {
+    fetchpp::dns_cache cache(ioc.get_executor(), 60s, 5s, 2);
+    cache.store("a", 80, {}, results);
+    cache.store("b", 80, {}, results);
+    cache.store("c", 80, {}, results);
+    CHECK(cache.size() == 2);
+    CHECK_FALSE(cache.lookup("a", 80).has_value());
+    CHECK(cache.lookup("c", 80).has_value());
+    INFO("storing a known host does not evict");
+    cache.store("c", 80, {}, results);
+    CHECK(cache.size() == 2);
+  }
+
+  SECTION("once expired")
+  {
+    fetchpp::dns_cache cache(ioc.get_executor(), 1ms, 1ms);
+    cache.store("a", 80, {}, results);
+    std::this_thread::sleep_for(5ms);
+    cache.store("b", 80, {}, results);
+    CHECK(cache.size() == 1);
+  }
+}
+
 TEST_CASE_METHOD(worker_fixture,
                  "transport one fake tcp",
                  "[fake][http][poly_body][transport]")
@@ -195,6 +325,33 @@ TEST_CASE_METHOD(ioc_fixture,
   REQUIRE_NOTHROW(ts.async_close(boost::asio::use_future).get());
 }
 
+TEST_CASE_METHOD(ioc_fixture,
+                 "transport stops its connection race",
+                 "[transport][http][delay]")
+{
+  // a non-routable address, the attempts never complete by themselves
+  auto endpoint = fetchpp::plain_endpoint("10.255.255.1", 80);
+  fetchpp::tcp_async_transport ts(ioc.get_executor(), 5s);
+  auto connected = ts.async_connect(endpoint, boost::asio::use_future);
+  std::this_thread::sleep_for(100ms);
+  auto const now = std::chrono::high_resolution_clock::now();
+
+  SECTION("when aborted")
+  {
+    boost::asio::post(ioc, [&] { ts.abort(); });
+  }
+  SECTION("when closed")
+  {
+    REQUIRE_NOTHROW(ts.async_close(boost::asio::use_future).get());
+  }
+
+  REQUIRE_THROWS_MATCHES(connected.get(),
+                         boost::system::system_error,
+                         HasErrorCode(boost::asio::error::operation_aborted));
+  auto const end = std::chrono::high_resolution_clock::now();
+  REQUIRE(1s > end - now);
+}
+
 TEST_CASE_METHOD(ioc_fixture,
                  "transport one ssl over timeout",
                  "[transport][https][delay]")
@@ -217,6 +374,45 @@ TEST_CASE_METHOD(ioc_fixture,
   REQUIRE(1.5s > end - now);
 }
 
+TEST_CASE_METHOD(ioc_fixture,
+                 "ssl transports resume cached sessions",
+                 "[transport][https][ssl_session]")
+{
+  auto const url = URL("get"_https);
+  ssl::context context(ssl::context::tlsv12_client);
+  fetchpp::ssl_session_cache::attach(context);
+  auto cache = std::make_shared<fetchpp::ssl_session_cache>();
+  auto endpoint = fetchpp::detail::to_endpoint<true>(url);
+
+  for (auto i = 0; i < 2; ++i)
+  {
+    fetchpp::ssl_async_transport ts(ioc.get_executor(), 5s, context);
+    ts.set_ssl_session_cache(cache);
+    REQUIRE_NOTHROW(ts.async_connect(endpoint, boost::asio::use_future).get());
+    auto const request = fetchpp::http::request(fetchpp::http::verb::get, url);
+    fetchpp::http::response response;
+    REQUIRE_NOTHROW(fetchpp::async_process_one(
+                        ts, request, response, boost::asio::use_future)
+                        .get());
+    REQUIRE_NOTHROW(ts.async_close(boost::asio::use_future).get());
+  }
+  CHECK(cache->size() == 1);
+  CHECK(cache->handshakes() == 2);
+  CHECK(cache->resumptions() == 1);
+
+  SECTION("but not from another context")
+  {
+    ssl::context other(ssl::context::tlsv12_client);
+    fetchpp::ssl_session_cache::attach(other);
+    fetchpp::ssl_async_transport ts(ioc.get_executor(), 5s, other);
+    ts.set_ssl_session_cache(cache);
+    REQUIRE_NOTHROW(ts.async_connect(endpoint, boost::asio::use_future).get());
+    REQUIRE_NOTHROW(ts.async_close(boost::asio::use_future).get());
+    CHECK(cache->handshakes() == 3);
+    CHECK(cache->resumptions() == 1);
+  }
+}
+
 TEST_CASE_METHOD(ioc_fixture,
                  "transport closes and reopens",
                  "[transport][https][close]")
@@ -2,6 +2,7 @@
 
 #include <fetchpp/fetch.hpp>
 #include <fetchpp/get.hpp>
+#include <fetchpp/pooled_client.hpp>
 #include <fetchpp/post.hpp>
 #include <fetchpp/version.hpp>
 
@@ -231,6 +232,36 @@ TEST_CASE_METHOD(ioc_fixture, "http async get", "[https][get]")
                EqualsHeader(json.at("headers"), "X-Random-Header"));
 }
 
+TEST_CASE_METHOD(ioc_fixture,
+                 "http async get with a context",
+                 "[https][get][ssl_context]")
+{
+  CHECK(&fetchpp::default_ssl_context() == &fetchpp::default_ssl_context());
+
+  auto const url = GENERATE("get"_http, "get"_https);
+  INFO("requesting " << url);
+  fetchpp::net::ssl::context context(fetchpp::net::ssl::context::tls_client);
+  auto response =
+      fetchpp::async_get(ex, context, url, boost::asio::use_future).get();
+  REQUIRE(response.result_int() == 200);
+}
+
+TEST_CASE_METHOD(ioc_fixture,
+                 "free functions reuse pooled connections",
+                 "[https][get][pooled]")
+{
+  auto& client = fetchpp::pooled_client(ex);
+  CHECK(&client == &fetchpp::pooled_client(ex));
+
+  for (auto i = 0; i < 2; ++i)
+  {
+    auto response =
+        fetchpp::async_get(ex, "get"_https, boost::asio::use_future).get();
+    REQUIRE(response.result_int() == 200);
+  }
+  CHECK(client.session_count() == 1);
+}
+
 TEST_CASE_METHOD(ioc_fixture,
                  "http async get with lambda",
                  "[https][get][lambda]")